@@ -0,0 +1,29 @@
+# starts a login server and n peers of the given build (e.g., build/release), lets them run for the given number of
+# seconds and prints the round time reports of the peers (see Client::record_round_time), e.g.,
+#   ./benchmark_round_time.sh build/debug && ./benchmark_round_time.sh build/release
+build_dir=${1:?"usage: $0 <build dir> [clients] [seconds]"}
+instances=${2:-81}
+seconds=${3:-120}
+
+log_dir=$(mktemp -d)
+pids=""
+
+(cd "$build_dir/server" && exec ./login_server "$instances") > "$log_dir/login_server.log" 2>&1 &
+pids="$pids $!"
+sleep 1
+for ((i=1;i<=($instances);i++))
+do
+   (cd "$build_dir/client" && exec ./peer) > "$log_dir/peer$i.log" 2>&1 &
+   pids="$pids $!"
+done
+
+sleep "$seconds"
+kill $pids 2> /dev/null
+wait 2> /dev/null
+
+grep -h "^round time" "$log_dir"/peer*.log | awk '
+  { n++; mean += $5; if ($8 > max) max = $8; profile = $3 }
+  END {
+    if (n == 0) { print "no round time reports (see '"$log_dir"')"; exit 1 }
+    printf "%s %d reports, mean round time %.3f ms, max %.3f ms\n", profile, n, mean / n, max
+  }'
@@ -0,0 +1,75 @@
+#include <benchmark/benchmark.h>
+#include "../include/shared_structs.h"
+#include "../include/shared_functions.h"
+#include "../server/trusted/quorum_assignment.h"
+#include "paper_parameters.h"
+
+using namespace c1;
+using namespace c1::benchmarks;
+
+namespace {
+
+/**
+ * The quorum tables of the login server for num_clients clients, built as by ServerEnclave::prepare_bootstrap and
+ * build_quorum_tables.
+ */
+struct BootstrapTables {
+  PaperParameters parameters;
+  std::vector<PeerInformation> clients;
+  std::vector<uint64_t> clients_associated_quorums;
+  std::vector<uint64_t> clients_emulated_quorums;
+  std::vector<std::vector<PeerInformation>> associated_quorums;
+  std::vector<std::vector<PeerInformation>> emulated_quorums;
+  std::vector<std::map<uint64_t, std::vector<PeerInformation>>> gamma_route_for_quorum;
+
+  explicit BootstrapTables(uint64_t num_clients) : parameters(num_clients) {
+    auto num_quorums = uint64_t{1} << parameters.dimension;
+    for (uint64_t i = 0; i < num_clients; ++i) {
+      clients.emplace_back(i, Uri(127, 0, 0, 1, 10000 + i % 50000));
+      clients_associated_quorums.push_back(i * num_quorums / num_clients);
+    }
+    clients_emulated_quorums = server::assign_balanced_quorums(num_clients, num_quorums, std::mt19937_64(7));
+    associated_quorums.assign(num_quorums, {});
+    emulated_quorums.assign(num_quorums, {});
+    for (uint64_t i = 0; i < num_clients; ++i) {
+      associated_quorums[clients_associated_quorums[i]].push_back(clients[i]);
+      emulated_quorums[clients_emulated_quorums[i]].push_back(clients[i]);
+    }
+    gamma_route_for_quorum.assign(num_quorums, {});
+    for (uint64_t quorum = 0; quorum < num_quorums; ++quorum) {
+      auto &gamma_route = gamma_route_for_quorum[quorum];
+      for_all_neighbors(quorum, parameters.dimension, [&](uint64_t neighbor_quorum) {
+        gamma_route[neighbor_quorum] = emulated_quorums[neighbor_quorum];
+      });
+    }
+  }
+};
+
+/** serializes the init messages of all clients (as one bootstrap worker does) */
+void BM_bootstrap_init_messages(benchmark::State &state) {
+  BootstrapTables tables(state.range(0));
+  std::array<uint8_t, SGX_AESGCM_KEY_SIZE> sk_pseud{1}, sk_enc{2};
+  std::array<uint8_t, SGX_CMAC_KEY_SIZE> sk_routing{3};
+  std::vector<char> batch;
+  size_t bytes = 0;
+  for (auto _ : state) {
+    bytes = 0;
+    for (uint64_t i = 0; i < tables.clients.size(); ++i) {
+      batch.clear();
+      InitMessage::serialize_to(batch, i, tables.clients.size(), tables.parameters.dimension,
+                                tables.clients_associated_quorums[i], tables.clients_emulated_quorums[i],
+                                tables.emulated_quorums[tables.clients_associated_quorums[i]],
+                                tables.associated_quorums[tables.clients_emulated_quorums[i]],
+                                tables.gamma_route_for_quorum[tables.clients_emulated_quorums[i]],
+                                sk_pseud, sk_enc, sk_routing);
+      bytes += batch.size();
+      benchmark::DoNotOptimize(batch.data());
+    }
+  }
+  state.counters["init_message_bytes"] = static_cast<double>(bytes);
+  state.SetItemsProcessed(state.iterations() * tables.clients.size());
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_bootstrap_init_messages)->Arg(81)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+}
@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+#include "../include/cryptlib.h"
+#include "../client/trusted/structures/aad_tuple.h"
+#include "paper_parameters.h"
+
+using namespace c1;
+using namespace c1::benchmarks;
+
+namespace {
+
+/** the plaintext sizes: one message tuple (an announcement), a batch of routing tuples, a full payload to a peer */
+void plaintext_sizes(benchmark::internal::Benchmark *benchmark) {
+  benchmark->Arg(client::MessageTuple::kSerializedSize)
+      ->Arg(64 * client::RoutingSchemeTuple::kSerializedSize)
+      ->Arg(256 * 1024);
+}
+
+void BM_encrypt(benchmark::State &state) {
+  InputGenerator input;
+  auto key = input.bytes(SGX_AESGCM_KEY_SIZE);
+  auto p = input.bytes(state.range(0));
+  auto aad = input.bytes(client::AadTuple::kHeaderSize);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cryptlib::encrypt(*reinterpret_cast<const sgx_aes_gcm_128bit_key_t *>(key.data()), p, aad));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_encrypt)->Apply(plaintext_sizes);
+
+void BM_decrypt(benchmark::State &state) {
+  InputGenerator input;
+  auto key = input.bytes(SGX_AESGCM_KEY_SIZE);
+  auto &sk_enc = *reinterpret_cast<const sgx_aes_gcm_128bit_key_t *>(key.data());
+  auto c = cryptlib::encrypt(sk_enc, input.bytes(state.range(0)), input.bytes(client::AadTuple::kHeaderSize));
+  std::vector<uint8_t> p, aad;
+  for (auto _ : state) {
+    if (!cryptlib::decrypt(sk_enc, c, p, aad)) {
+      state.SkipWithError("decryption failed");
+      break;
+    }
+    benchmark::DoNotOptimize(p.data());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_decrypt)->Apply(plaintext_sizes);
+
+/** decrypt_in_place as used by traffic_in (the copy restoring the ciphertext is part of the measured time) */
+void BM_decrypt_in_place(benchmark::State &state) {
+  InputGenerator input;
+  auto key = input.bytes(SGX_AESGCM_KEY_SIZE);
+  auto &sk_enc = *reinterpret_cast<const sgx_aes_gcm_128bit_key_t *>(key.data());
+  auto c = cryptlib::encrypt(sk_enc, input.bytes(state.range(0)), input.bytes(client::AadTuple::kHeaderSize));
+  std::vector<uint8_t> buffer;
+  cryptlib::CiphertextRanges ranges{};
+  for (auto _ : state) {
+    buffer = c;
+    if (!cryptlib::decrypt_in_place(sk_enc, buffer, ranges)) {
+      state.SkipWithError("decrypt_in_place failed");
+      break;
+    }
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_decrypt_in_place)->Apply(plaintext_sizes);
+
+/** one evaluation of the routing PRF (done once per routed message and round), by the number of nodes */
+void BM_get_intermediate_target(benchmark::State &state) {
+  PaperParameters parameters(state.range(0));
+  InputGenerator input;
+  auto key = input.bytes(SGX_CMAC_KEY_SIZE);
+  auto &sk_routing = *reinterpret_cast<const sgx_cmac_128bit_key_t *>(key.data());
+  auto bucket_dst = input.pseudonym();
+  round_t ell_dst = 1000;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cryptlib::get_intermediate_target(sk_routing, bucket_dst, ell_dst++, parameters.dimension));
+  }
+}
+BENCHMARK(BM_get_intermediate_target)->Arg(kNumNodesSmall)->Arg(kNumNodesMedium)->Arg(kNumNodesLarge);
+
+}
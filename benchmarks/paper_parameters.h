@@ -0,0 +1,85 @@
+#ifndef NETWORK_SGX_EXAMPLE_PAPER_PARAMETERS_H
+#define NETWORK_SGX_EXAMPLE_PAPER_PARAMETERS_H
+
+#include <cstdint>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "../include/config.h"
+#include "../include/shared_structs.h"
+#include "../client/trusted/structures.h"
+
+namespace c1::benchmarks {
+
+/** the numbers of nodes the benchmarks are run for (81 is the default of the login server) */
+constexpr int64_t kNumNodesSmall{81};
+constexpr int64_t kNumNodesMedium{1024};
+constexpr int64_t kNumNodesLarge{16384};
+
+/**
+ * The parameters a network of num_nodes nodes runs with, derived as by the login server (dimension) and by the peers
+ * (max_quorum_size, m_corrupt, see ClientEnclave::init).
+ */
+struct PaperParameters {
+  uint64_t num_nodes;
+  uint64_t dimension = 1;
+  /** the (expected) number of nodes associated to each quorum */
+  size_t nodes_per_quorum;
+  size_t max_quorum_size;
+  size_t m_corrupt;
+
+  explicit PaperParameters(uint64_t num_nodes, size_t num_nodes_per_quorum = 10) : num_nodes(num_nodes) {
+    while ((uint64_t{2} << dimension) * num_nodes_per_quorum <= num_nodes) {
+      dimension++;
+    }
+    nodes_per_quorum = num_nodes >> dimension;
+    max_quorum_size =
+        static_cast<size_t>(std::ceil((1 + 1.0 / (kX * kX)) * std::pow(std::log2(num_nodes), 1 + kEpsilon)));
+    m_corrupt = max_quorum_size / 2 - 1;
+  }
+};
+
+/**
+ * Generates the inputs of the benchmarks (deterministically, so that runs are comparable).
+ */
+class InputGenerator {
+  std::mt19937_64 random_{42};
+
+ public:
+  uint64_t below(uint64_t bound) {
+    return std::uniform_int_distribution<uint64_t>(0, bound - 1)(random_);
+  }
+
+  std::vector<uint8_t> bytes(size_t len) {
+    std::vector<uint8_t> result(len);
+    for (auto &byte : result) {
+      byte = static_cast<uint8_t>(random_());
+    }
+    return result;
+  }
+
+  client::Pseudonym pseudonym() {
+    return client::Pseudonym(bytes(kPseudonymSize).data());
+  }
+
+  client::MessageTuple message_tuple(round_t t_dst) {
+    return client::MessageTuple{pseudonym(), client::Message(bytes(kMessageSize).data()), pseudonym(), t_dst};
+  }
+
+  PeerInformation peer(uint64_t id) {
+    return PeerInformation{id, Uri(127, 0, 0, 1, 10000 + id)};
+  }
+
+  /** peers first_id, ..., first_id + num - 1 */
+  std::vector<PeerInformation> peers(uint64_t first_id, size_t num) {
+    std::vector<PeerInformation> result;
+    for (size_t i = 0; i < num; ++i) {
+      result.push_back(peer(first_id + i));
+    }
+    return result;
+  }
+};
+
+}
+
+#endif //NETWORK_SGX_EXAMPLE_PAPER_PARAMETERS_H
@@ -0,0 +1,132 @@
+#include <benchmark/benchmark.h>
+#include "../client/trusted/routing_scheme.h"
+#include "../client/trusted/overlay_structure_scheme.h"
+#include "../client/trusted/m_corrupt_filter.h"
+#include "../include/shared_functions.h"
+#include "paper_parameters.h"
+
+using namespace c1;
+using namespace c1::client;
+using namespace c1::benchmarks;
+
+namespace {
+
+/** the number of nodes times the number of (distinct) tuples */
+void scheme_sizes(benchmark::internal::Benchmark *benchmark) {
+  benchmark->ArgsProduct({{kNumNodesSmall, kNumNodesMedium, kNumNodesLarge}, {16, 256, 4096}});
+}
+
+/**
+ * Routing tuples that are in the middle of their routing (l_dst is 1 to 2 * dimension rounds ahead); about every
+ * other bucket gets more than k_recv messages, so that route() has to cancel some of them.
+ */
+std::vector<RoutingSchemeTuple> make_routing_tuples(InputGenerator &input, const PaperParameters &parameters,
+                                                    size_t num, round_t cur_round) {
+  auto num_quorums = uint64_t{1} << parameters.dimension;
+  std::vector<Pseudonym> buckets;
+  for (size_t i = 0; i < std::max<size_t>(num / (kRecv + 1), 1); ++i) {
+    buckets.push_back(input.pseudonym());
+  }
+  std::vector<RoutingSchemeTuple> result;
+  for (size_t i = 0; i < num; ++i) {
+    result.push_back(RoutingSchemeTuple{input.message_tuple(1000), input.below(num_quorums),
+                                        buckets[input.below(buckets.size())],
+                                        cur_round + 1 + input.below(2 * parameters.dimension),
+                                        input.below(num_quorums)});
+  }
+  return result;
+}
+
+/** one call of route() per round (the copy of set_s into the round arena is part of the measured time) */
+void BM_route(benchmark::State &state) {
+  PaperParameters parameters(state.range(0));
+  InputGenerator input;
+  round_t cur_round = 100;
+  auto tuples = make_routing_tuples(input, parameters, state.range(1), cur_round);
+  auto key = input.bytes(SGX_CMAC_KEY_SIZE);
+  auto &sk_routing = *reinterpret_cast<const sgx_cmac_128bit_key_t *>(key.data());
+  RoundArena arena;
+  for (auto _ : state) {
+    arena.reset();
+    arena_vector<RoutingSchemeTuple> set_s(tuples.begin(), tuples.end(), ArenaAllocator<RoutingSchemeTuple>(arena));
+    benchmark::DoNotOptimize(RoutingScheme::route(set_s, cur_round, parameters.dimension, sk_routing));
+  }
+  state.SetItemsProcessed(state.iterations() * tuples.size());
+}
+BENCHMARK(BM_route)->Apply(scheme_sizes);
+
+/**
+ * The majority vote over the messages received from a quorum: every node of a (maximal) quorum sends the same
+ * state.range(1) messages, so each of them has to be counted max_quorum_size times.
+ */
+void BM_obtain_elements_that_exceed_m_corrupt(benchmark::State &state) {
+  PaperParameters parameters(state.range(0));
+  InputGenerator input;
+  std::vector<MessageTuple> distinct;
+  for (int64_t i = 0; i < state.range(1); ++i) {
+    distinct.push_back(input.message_tuple(1000 + i)); // distinct t_dst, as MessageTuple is ordered by t_dst only
+  }
+  std::vector<MessageTuple> received;
+  for (size_t sender = 0; sender < parameters.max_quorum_size; ++sender) {
+    received.insert(received.end(), distinct.begin(), distinct.end());
+  }
+  RoundArena arena;
+  for (auto _ : state) {
+    arena.reset();
+    auto result = obtain_elements_that_exceed_m_corrupt(received, parameters.m_corrupt, arena);
+    if (result.size() != distinct.size()) {
+      state.SkipWithError("unexpected number of elements");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * received.size());
+}
+BENCHMARK(BM_obtain_elements_that_exceed_m_corrupt)->Apply(scheme_sizes);
+
+/** the same for the routing messages, which are voted on per sender (i.e., a vector of tuples is the element) */
+void BM_obtain_elements_that_exceed_m_corrupt_routing(benchmark::State &state) {
+  PaperParameters parameters(state.range(0));
+  InputGenerator input;
+  auto tuples = make_routing_tuples(input, parameters, state.range(1), 100);
+  std::vector<std::vector<RoutingSchemeTuple>> received(parameters.max_quorum_size, tuples);
+  RoundArena arena;
+  for (auto _ : state) {
+    arena.reset();
+    benchmark::DoNotOptimize(obtain_elements_that_exceed_m_corrupt(received, parameters.m_corrupt, arena));
+  }
+  state.SetItemsProcessed(state.iterations() * received.size() * tuples.size());
+}
+BENCHMARK(BM_obtain_elements_that_exceed_m_corrupt_routing)->Apply(scheme_sizes);
+
+/**
+ * One call of OverlayStructureScheme::update() per round, over whole reconfiguration periods. In every round, each
+ * node of the quorum forwards an emulate request and an emulate request received message.
+ */
+void BM_overlay_update(benchmark::State &state) {
+  PaperParameters parameters(state.range(0));
+  InputGenerator input;
+  auto num_quorums = uint64_t{1} << parameters.dimension;
+  std::map<uint64_t, std::vector<PeerInformation>> gamma_route;
+  gamma_route[0] = input.peers(0, parameters.nodes_per_quorum);
+  for_all_neighbors(0, parameters.dimension, [&](onid_t neighbor) {
+    gamma_route[neighbor] = input.peers(neighbor * parameters.nodes_per_quorum, parameters.nodes_per_quorum);
+  });
+  auto own_id = gamma_route[0].front();
+  OverlayStructureScheme overlay;
+  overlay.init(0, 0, gamma_route.at(1), gamma_route.at(0), gamma_route, parameters.dimension,
+               parameters.dimension + 7, own_id);
+
+  std::vector<OverlayStructureSchemeMessage> set_s;
+  for (const auto &peer : gamma_route.at(0)) {
+    set_s.push_back(OverlayStructureSchemeMessage::createEmulateRequestMsg(input.below(num_quorums), peer));
+    set_s.push_back(OverlayStructureSchemeMessage::createEmulateRequestReceivedMsg(input.below(num_quorums), peer));
+  }
+  round_t round = 100;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(&overlay.update(round++, set_s));
+  }
+  state.SetItemsProcessed(state.iterations() * set_s.size());
+}
+BENCHMARK(BM_overlay_update)->Arg(kNumNodesSmall)->Arg(kNumNodesMedium)->Arg(kNumNodesLarge);
+
+}
@@ -0,0 +1,116 @@
+#include <benchmark/benchmark.h>
+#include "../include/serialization.h"
+#include "../client/trusted/structures/aad_tuple.h"
+#include "paper_parameters.h"
+
+using namespace c1;
+using namespace c1::client;
+using namespace c1::benchmarks;
+
+namespace {
+
+/**
+ * Creates a tuple of type T of the size it has in a network with the given parameters.
+ */
+template<typename T>
+T make_tuple(InputGenerator &input, const PaperParameters &parameters);
+
+template<>
+MessageTuple make_tuple<MessageTuple>(InputGenerator &input, const PaperParameters &) {
+  return input.message_tuple(1000);
+}
+
+template<>
+AgreementTuple make_tuple<AgreementTuple>(InputGenerator &input, const PaperParameters &parameters) {
+  std::vector<uint64_t> s(parameters.max_quorum_size); // all nodes of the quorum are aware
+  for (auto &id : s) {
+    id = input.below(parameters.num_nodes);
+  }
+  return AgreementTuple{input.message_tuple(1000), s, 100};
+}
+
+template<>
+RoutingSchemeTuple make_tuple<RoutingSchemeTuple>(InputGenerator &input, const PaperParameters &parameters) {
+  auto num_quorums = uint64_t{1} << parameters.dimension;
+  return RoutingSchemeTuple{input.message_tuple(1000), input.below(num_quorums), input.pseudonym(), 100,
+                            input.below(num_quorums)};
+}
+
+template<>
+DecryptedPseudonym make_tuple<DecryptedPseudonym>(InputGenerator &input, const PaperParameters &parameters) {
+  return DecryptedPseudonym{input.below(uint64_t{1} << parameters.dimension),
+                            input.peer(input.below(parameters.num_nodes)),
+                            static_cast<uint8_t>(input.below(256))};
+}
+
+/** a hand over message (the largest overlay message): gamma_route of the own quorum and its neighbors */
+template<>
+OverlayStructureSchemeMessage make_tuple<OverlayStructureSchemeMessage>(InputGenerator &input,
+                                                                        const PaperParameters &parameters) {
+  std::map<onid_t, std::vector<PeerInformation>> gamma_route;
+  for (onid_t onid = 0; onid <= parameters.dimension; ++onid) {
+    gamma_route[onid] = input.peers(onid * parameters.nodes_per_quorum, parameters.nodes_per_quorum);
+  }
+  return OverlayStructureSchemeMessage::createHandOverMessage(gamma_route, input.peers(0, parameters.nodes_per_quorum));
+}
+
+template<>
+AadTuple make_tuple<AadTuple>(InputGenerator &input, const PaperParameters &) {
+  return AadTuple{input.peer(1), input.peer(2), 100, {}};
+}
+
+/** the number of nodes times the number of tuples in the vector */
+void vector_sizes(benchmark::internal::Benchmark *benchmark) {
+  benchmark->ArgsProduct({{kNumNodesSmall, kNumNodesLarge}, {1, 64, 1024}});
+}
+
+template<typename T>
+std::vector<T> make_tuples(const benchmark::State &state) {
+  PaperParameters parameters(state.range(0));
+  InputGenerator input;
+  std::vector<T> result;
+  for (int64_t i = 0; i < state.range(1); ++i) {
+    result.push_back(make_tuple<T>(input, parameters));
+  }
+  return result;
+}
+
+template<typename T>
+void BM_serialize_vec(benchmark::State &state) {
+  auto vec = make_tuples<T>(state);
+  std::vector<uint8_t> working_vec;
+  for (auto _ : state) {
+    working_vec.clear(); // as the enclave does, the capacity is kept
+    serialize_vec(working_vec, vec);
+    benchmark::DoNotOptimize(working_vec.data());
+  }
+  state.SetBytesProcessed(state.iterations() * working_vec.size());
+  state.SetItemsProcessed(state.iterations() * vec.size());
+}
+
+template<typename T>
+void BM_deserialize_vec(benchmark::State &state) {
+  std::vector<uint8_t> working_vec;
+  serialize_vec(working_vec, make_tuples<T>(state));
+  for (auto _ : state) {
+    size_t cur = 0;
+    benchmark::DoNotOptimize(deserialize_vec<T>(working_vec, cur));
+  }
+  state.SetBytesProcessed(state.iterations() * working_vec.size());
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+BENCHMARK_TEMPLATE(BM_serialize_vec, MessageTuple)->Apply(vector_sizes);
+BENCHMARK_TEMPLATE(BM_deserialize_vec, MessageTuple)->Apply(vector_sizes);
+BENCHMARK_TEMPLATE(BM_serialize_vec, AgreementTuple)->Apply(vector_sizes);
+BENCHMARK_TEMPLATE(BM_deserialize_vec, AgreementTuple)->Apply(vector_sizes);
+BENCHMARK_TEMPLATE(BM_serialize_vec, RoutingSchemeTuple)->Apply(vector_sizes);
+BENCHMARK_TEMPLATE(BM_deserialize_vec, RoutingSchemeTuple)->Apply(vector_sizes);
+BENCHMARK_TEMPLATE(BM_serialize_vec, DecryptedPseudonym)->Apply(vector_sizes);
+BENCHMARK_TEMPLATE(BM_deserialize_vec, DecryptedPseudonym)->Apply(vector_sizes);
+BENCHMARK_TEMPLATE(BM_serialize_vec, OverlayStructureSchemeMessage)->Apply(vector_sizes);
+BENCHMARK_TEMPLATE(BM_deserialize_vec, OverlayStructureSchemeMessage)->Apply(vector_sizes);
+BENCHMARK_TEMPLATE(BM_serialize_vec, AadTuple)->Apply(vector_sizes);
+BENCHMARK_TEMPLATE(BM_deserialize_vec, AadTuple)->Apply(vector_sizes);
+
+}
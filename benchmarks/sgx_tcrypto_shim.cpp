@@ -0,0 +1,121 @@
+// Software implementations (on top of OpenSSL) of the parts of sgx_tcrypto and sgx_trts used by cryptlib, so that the
+// benchmarks run outside of an enclave on any Linux machine. Only meant for the benchmarks: nothing here is
+// constant-time beyond what OpenSSL guarantees, and sgx_read_rand does not use RDRAND.
+
+#include <sgx_tcrypto.h>
+#include <sgx_trts.h>
+#include <memory>
+#include <algorithm>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#else
+#include <openssl/cmac.h>
+#endif
+
+namespace {
+
+struct CipherCtxDeleter {
+  void operator()(EVP_CIPHER_CTX *ctx) const {
+    EVP_CIPHER_CTX_free(ctx);
+  }
+};
+typedef std::unique_ptr<EVP_CIPHER_CTX, CipherCtxDeleter> CipherCtx;
+
+/**
+ * AES-128-GCM (in either direction, OpenSSL's update/final calls are the same for both)
+ * @param encrypt
+ * @param tag the computed tag is written to it (encrypt) or it is checked against it (decrypt)
+ */
+sgx_status_t aes_gcm(bool encrypt, const uint8_t *key, const uint8_t *src, uint32_t src_len, uint8_t *dst,
+                     const uint8_t *iv, uint32_t iv_len, const uint8_t *aad, uint32_t aad_len, uint8_t *tag) {
+  if (key == nullptr || iv == nullptr || iv_len == 0 || tag == nullptr
+      || (src_len > 0 && (src == nullptr || dst == nullptr)) || (aad_len > 0 && aad == nullptr)) {
+    return SGX_ERROR_INVALID_PARAMETER;
+  }
+  CipherCtx ctx(EVP_CIPHER_CTX_new());
+  int len = 0;
+  if (!ctx
+      || EVP_CipherInit_ex(ctx.get(), EVP_aes_128_gcm(), nullptr, nullptr, nullptr, encrypt) != 1
+      || EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_IVLEN, static_cast<int>(iv_len), nullptr) != 1
+      || EVP_CipherInit_ex(ctx.get(), nullptr, nullptr, key, iv, encrypt) != 1
+      || (aad_len > 0 && EVP_CipherUpdate(ctx.get(), nullptr, &len, aad, static_cast<int>(aad_len)) != 1)
+      || (src_len > 0 && EVP_CipherUpdate(ctx.get(), dst, &len, src, static_cast<int>(src_len)) != 1)) {
+    return SGX_ERROR_UNEXPECTED;
+  }
+  if (encrypt) {
+    if (EVP_CipherFinal_ex(ctx.get(), dst + len, &len) != 1
+        || EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_GET_TAG, SGX_AESGCM_MAC_SIZE, tag) != 1) {
+      return SGX_ERROR_UNEXPECTED;
+    }
+    return SGX_SUCCESS;
+  }
+  if (EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_TAG, SGX_AESGCM_MAC_SIZE, tag) != 1) {
+    return SGX_ERROR_UNEXPECTED;
+  }
+  return EVP_CipherFinal_ex(ctx.get(), dst + len, &len) == 1 ? SGX_SUCCESS : SGX_ERROR_MAC_MISMATCH;
+}
+
+}
+
+extern "C" {
+
+sgx_status_t sgx_rijndael128GCM_encrypt(const sgx_aes_gcm_128bit_key_t *p_key, const uint8_t *p_src, uint32_t src_len,
+                                        uint8_t *p_dst, const uint8_t *p_iv, uint32_t iv_len, const uint8_t *p_aad,
+                                        uint32_t aad_len, sgx_aes_gcm_128bit_tag_t *p_out_mac) {
+  return aes_gcm(true, p_key == nullptr ? nullptr : *p_key, p_src, src_len, p_dst, p_iv, iv_len, p_aad, aad_len,
+                 p_out_mac == nullptr ? nullptr : *p_out_mac);
+}
+
+sgx_status_t sgx_rijndael128GCM_decrypt(const sgx_aes_gcm_128bit_key_t *p_key, const uint8_t *p_src, uint32_t src_len,
+                                        uint8_t *p_dst, const uint8_t *p_iv, uint32_t iv_len, const uint8_t *p_aad,
+                                        uint32_t aad_len, const sgx_aes_gcm_128bit_tag_t *p_in_mac) {
+  if (p_in_mac == nullptr) {
+    return SGX_ERROR_INVALID_PARAMETER;
+  }
+  sgx_aes_gcm_128bit_tag_t tag; // OpenSSL takes a non-const tag
+  std::copy(*p_in_mac, *p_in_mac + SGX_AESGCM_MAC_SIZE, tag);
+  return aes_gcm(false, p_key == nullptr ? nullptr : *p_key, p_src, src_len, p_dst, p_iv, iv_len, p_aad, aad_len, tag);
+}
+
+sgx_status_t sgx_rijndael128_cmac_msg(const sgx_cmac_128bit_key_t *p_key, const uint8_t *p_src, uint32_t src_len,
+                                      sgx_cmac_128bit_tag_t *p_mac) {
+  if (p_key == nullptr || p_mac == nullptr || (src_len > 0 && p_src == nullptr)) {
+    return SGX_ERROR_INVALID_PARAMETER;
+  }
+  size_t mac_len = 0;
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  // fetching the algorithm is expensive, so it is done once (the contexts are cheap)
+  static EVP_MAC *cmac = EVP_MAC_fetch(nullptr, "CMAC", nullptr);
+  std::unique_ptr<EVP_MAC_CTX, decltype(&EVP_MAC_CTX_free)> ctx(cmac == nullptr ? nullptr : EVP_MAC_CTX_new(cmac),
+                                                                &EVP_MAC_CTX_free);
+  char cipher_name[] = "AES-128-CBC";
+  OSSL_PARAM params[] = {OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_CIPHER, cipher_name, 0),
+                         OSSL_PARAM_construct_end()};
+  if (!ctx
+      || EVP_MAC_init(ctx.get(), *p_key, SGX_CMAC_KEY_SIZE, params) != 1
+      || EVP_MAC_update(ctx.get(), p_src, src_len) != 1
+      || EVP_MAC_final(ctx.get(), *p_mac, &mac_len, SGX_CMAC_MAC_SIZE) != 1) {
+    return SGX_ERROR_UNEXPECTED;
+  }
+#else
+  std::unique_ptr<CMAC_CTX, decltype(&CMAC_CTX_free)> ctx(CMAC_CTX_new(), &CMAC_CTX_free);
+  if (!ctx
+      || CMAC_Init(ctx.get(), *p_key, SGX_CMAC_KEY_SIZE, EVP_aes_128_cbc(), nullptr) != 1
+      || CMAC_Update(ctx.get(), p_src, src_len) != 1
+      || CMAC_Final(ctx.get(), *p_mac, &mac_len) != 1) {
+    return SGX_ERROR_UNEXPECTED;
+  }
+#endif
+  return mac_len == SGX_CMAC_MAC_SIZE ? SGX_SUCCESS : SGX_ERROR_UNEXPECTED;
+}
+
+sgx_status_t sgx_read_rand(unsigned char *rand, size_t length_in_bytes) {
+  if (rand == nullptr || length_in_bytes == 0) {
+    return SGX_ERROR_INVALID_PARAMETER;
+  }
+  return RAND_bytes(rand, static_cast<int>(length_in_bytes)) == 1 ? SGX_SUCCESS : SGX_ERROR_UNEXPECTED;
+}
+
+}
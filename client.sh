@@ -1,5 +1,7 @@
 bin="network_sgx_example_client"
-instances=80
+instances=${1:-80}
+# number of shards of the login server (the clients are spread over them round-robin)
+shards=${2:-1}
 
 runstring=""
 
@@ -7,7 +9,8 @@ for ((i=1;i<=($instances);i++))
 do
 #  runstring=$runstring ./$bin > /dev/null &
 #  runstring=$runstring ./$bin | sed "s/^/[client$i] /" &
-   screen -dmS "c$i" bash -c "./$bin; exec bash"
+   port=$((5671 + i % shards))
+   screen -dmS "c$i" bash -c "./$bin $port; exec bash"
 done
 
 #setsid sh -c '$runstring'
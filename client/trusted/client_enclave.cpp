@@ -2,6 +2,9 @@
 #include <sgx_tae_service.h>
 #include "../../include/config.h"
 #include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <optional>
 #include <structures/aad_tuple.h>
 #include "client_enclave.h"
 #include "enclave_t.h"  /* print_string */
@@ -35,7 +38,13 @@ void ClientEnclave::network_init(uint8_t ip1, uint8_t ip2, uint8_t ip3, uint8_t
 }
 
 void ClientEnclave::received_msg_from_server(const void *msg, size_t msg_len) {
-  if (get_message_type(msg) == kTypeInitMessage) {
+  if (msg_len >= sizeof(uint64_t) && get_message_type(msg) == kTypeInitMessage) {
+    InitMessage init_message(reinterpret_cast<const char *>(msg), msg_len);
+    if (!init_message.is_valid()) {
+      ocall_print_string("Received a malformed init message from the server! Ignored ...\n");
+      return;
+    }
+
     sgx_time_t current_time;
     sgx_time_source_nonce_t time_source_nonce;
     ASSERT(sgx_get_trusted_time(&current_time, &time_source_nonce) == SGX_SUCCESS);
@@ -43,8 +52,6 @@ void ClientEnclave::received_msg_from_server(const void *msg, size_t msg_len) {
     init_time_ = current_time;
     std::copy(std::begin(time_source_nonce), std::end(time_source_nonce), std::begin(init_time_nonce_));
 
-    InitMessage init_message(reinterpret_cast<const char *>(msg));
-
     memcpy(sk_pseud_, init_message.get_sk_pseud_(), SGX_AESGCM_KEY_SIZE);
     memcpy(sk_enc_, init_message.get_sk_enc_(), SGX_AESGCM_KEY_SIZE);
     memcpy(sk_routing_, init_message.get_sk_routing_(), SGX_CMAC_KEY_SIZE);
@@ -69,6 +76,7 @@ void ClientEnclave::received_msg_from_server(const void *msg, size_t msg_len) {
         static_cast<size_t>(std::ceil(8 * std::pow(overlay_dimension_, kEpsilon + 2) * kRecv * b_max));
 
     own_id_.id = init_message.get_receiver_id_();
+    own_handle_ = peer_registry_.intern(own_id_);
 
     initialized_ = true;
 
@@ -110,7 +118,7 @@ void ClientEnclave::generate_pseudonym(uint8_t pseudonym[kPseudonymSize]) {
 
   pseudonyms_.push_back(pseud);
   num_q_out_entries_for_round_for_pseudonym_.resize(num_q_out_entries_for_round_for_pseudonym_.size() + 1);
-  q_in_for_pseudonyms_.resize(q_in_for_pseudonyms_.size() + 1);
+  q_in_for_pseudonyms_.add_pseudonym();
 }
 
 void ClientEnclave::send_message(uint8_t n_src[kPseudonymSize],
@@ -121,69 +129,121 @@ void ClientEnclave::send_message(uint8_t n_src[kPseudonymSize],
     return;
   }
 
-  auto pseud_n_src_decr = decrypt_pseudonym(Pseudonym{n_src});
   auto pseud_n_src = Pseudonym{n_src};
-  auto msg_msg = Message{msg};
-  auto pseud_n_dst = Pseudonym{n_dst};
+  auto n_src_decr = decrypt_pseudonym(pseud_n_src);
+  auto result = n_src_decr ? queue_message(*n_src_decr, pseud_n_src, Message{msg}, Pseudonym{n_dst}, t_dst, get_time())
+                           : kUnknownSource;
+  switch (result) {
+    case kUnknownSource:
+      // this node does not have pseudonym n_src, abort
+      ocall_print_string("Source pseudonym does not exist at this node!\n");
+      break;
+    case kTooLate:
+      ocall_print_string("Message is too late! Canceled ...\n");
+      break;
+    case kLimitExceeded:
+      ocall_print_string("Message limit for that round was exceeded ...\n");
+      break;
+    default:
+      break;
+  }
+}
 
-  if (std::find(pseudonyms_.begin(), pseudonyms_.end(), pseud_n_src_decr) == pseudonyms_.end()) {
-    // this node does not have pseudonym n_src, abort
-    ocall_print_string("Source pseudonym does not exist at this node!\n");
-    return;
+size_t ClientEnclave::send_messages(const UserInterfaceMessageInjectionCommand *commands, size_t num_commands) {
+  if (!initialized_) {
+    return 0;
+  }
+
+  auto now = get_time();
+  // the decrypted source pseudonyms, std::nullopt for pseudonyms that could not be decrypted
+  std::map<std::array<uint8_t, kPseudonymSize>, std::optional<DecryptedPseudonym>> decrypted_sources;
+  std::array<size_t, kNumSendResults> num_results{};
+  for (size_t i = 0; i < num_commands; ++i) {
+    auto command = commands[i];
+    auto pseud_n_src = Pseudonym{command.n_src};
+    auto it = decrypted_sources.find(pseud_n_src.get());
+    if (it == decrypted_sources.end()) {
+      it = decrypted_sources.emplace(pseud_n_src.get(), decrypt_pseudonym(pseud_n_src)).first;
+    }
+    if (!it->second) {
+      num_results[kUnknownSource]++;
+      continue;
+    }
+    num_results[queue_message(*it->second, pseud_n_src, Message{command.msg}, Pseudonym{command.n_dst},
+                              command.t_dst, now)]++;
+  }
+
+  if (num_results[kQueued] != num_commands) { // one report for the whole batch
+    ocall_print_string(("Queued " + std::to_string(num_results[kQueued]) + " of " + std::to_string(num_commands)
+        + " messages (unknown source pseudonym: " + std::to_string(num_results[kUnknownSource]) + ", too late: "
+        + std::to_string(num_results[kTooLate]) + ", message limit exceeded: "
+        + std::to_string(num_results[kLimitExceeded]) + ")\n").c_str());
   }
+  return num_results[kQueued];
+}
 
-  ocall_print_string("TEMP\n");
+ClientEnclave::SendResult ClientEnclave::queue_message(const DecryptedPseudonym &n_src_decr,
+                                                       const Pseudonym &n_src,
+                                                       const Message &msg,
+                                                       const Pseudonym &n_dst,
+                                                       uint64_t t_dst,
+                                                       uint64_t now) {
+  if (!is_local_pseudonym(n_src_decr)) {
+    return kUnknownSource;
+  }
 
-  if (get_time() > t_dst
+  if (now > t_dst
       - (calculate_agreement_time(overlay_dimension_) + calculate_routing_time(overlay_dimension_) + 4) * 4 * kDelta) {
     // message is too late, abort
-    ocall_print_string("Message is too late! Canceled ...\n");
-    return;
+    return kTooLate;
   }
 
   int l_dst = calculate_round_from_t(t_dst);
-  auto &num_entries_for_round =
-      num_q_out_entries_for_round_for_pseudonym_.at(pseud_n_src_decr.get_local_num());
+  auto &num_entries_for_round = num_q_out_entries_for_round_for_pseudonym_.at(n_src_decr.get_local_num());
   if (num_entries_for_round.count(l_dst) != 0 && num_entries_for_round[l_dst] >= kSend) {
     // too many message for that round already sent
-    ocall_print_string("Message limit for that round was exceeded ...\n");
-    return;
+    return kLimitExceeded;
+  }
+  if (!q_out_.push(l_dst, MessageTuple{n_src, msg, n_dst, t_dst})) {
+    return kTooLate;
   }
-  MessageTuple m{pseud_n_src, msg_msg, pseud_n_dst, t_dst};
-  q_out_.push(m);
   if (num_entries_for_round.count(l_dst) == 0) {
     num_entries_for_round[l_dst] = 1;
   } else {
     num_entries_for_round[l_dst] += 1;
   }
+  return kQueued;
 }
 
 int ClientEnclave::receive_message(uint8_t *n_dst,
                                    uint8_t *msg,
                                    uint8_t *n_src,
                                    uint64_t *t_dst) {
-  if (!initialized_) {
+  const auto &messages = receive_messages(n_dst, 1);
+  if (messages.empty()) {
     return false;
   }
+  const auto &message_tuple = messages.front();
+  std::copy(message_tuple.m.get().data(), message_tuple.m.get().data() + kMessageSize, msg);
+  std::copy(message_tuple.n_src.get().data(), message_tuple.n_src.get().data() + kPseudonymSize, n_src);
+  *t_dst = message_tuple.t_dst;
+  return true;
+}
+
+const std::vector<MessageTuple> &ClientEnclave::receive_messages(uint8_t *n_dst, size_t max_messages) {
+  received_messages_.clear();
+  if (!initialized_) {
+    return received_messages_;
+  }
 
   auto pseud_n_dst = decrypt_pseudonym(Pseudonym{n_dst});
-  if (std::find(pseudonyms_.begin(), pseudonyms_.end(), pseud_n_dst) == pseudonyms_.end()) {
+  if (!pseud_n_dst || !is_local_pseudonym(*pseud_n_dst)) {
     // this node does not have pseudonym n_dst, abort
     ocall_print_string("This pseudonym does not exist!\n");
-    return false;
+    return received_messages_;
   }
-  auto &message_tuple = q_in_for_pseudonyms_.at(pseud_n_dst.get_local_num()).top();
-  if (message_tuple.t_dst > get_time()) {
-    // even the message with lowest t_dst is not due yet, abort
-    ocall_print_string("No message ready!\n");
-    return false;
-  }
-  std::copy(message_tuple.m.get().data(), message_tuple.m.get().data() + kMessageSize, msg);
-  std::copy(message_tuple.n_dst.get().data(), message_tuple.n_dst.get().data() + kMessageSize, n_dst);
-  *t_dst = message_tuple.t_dst;
-
-  q_in_for_pseudonyms_.at(pseud_n_dst.get_local_num()).pop();
-  return true;
+  q_in_for_pseudonyms_.pop_due(pseud_n_dst->get_local_num(), get_time(), max_messages, received_messages_);
+  return received_messages_;
 }
 
 int ClientEnclave::traffic_out() {
@@ -191,16 +251,6 @@ int ClientEnclave::traffic_out() {
     return false;
   }
 
-  typedef std::map<PeerInformation, std::vector<MessageTuple>> default_out_t;
-  default_out_t out_announce;
-  std::map<PeerInformation, std::vector<AgreementTuple>> out_agreement;
-  default_out_t out_inject;
-  std::map<PeerInformation, std::vector<RoutingSchemeTuple>> out_routing;
-  default_out_t out_predeliver;
-  default_out_t out_deliver;
-  std::vector<RoutingSchemeTuple> s_routing;
-
-
   // establish a round model
   auto subround = calculate_subround_from_t(get_time());
   if (subround % 4 != 0) {
@@ -219,117 +269,138 @@ int ClientEnclave::traffic_out() {
 
   // auto& in  // in must be treated differently, given our implementation
 
+  traffic_out_recorder_.begin_round();
+
+  // the out sets (kept from the previous round to reuse their memory)
+  outbox_.reset();
+  auto &out_routing = outbox_.routing;
+  auto &out_predeliver = outbox_.predeliver;
+  // all data needed during this call only is allocated from the round arena
+  round_arena_.reset();
+  ArenaAllocator<uint8_t> arena_allocator(round_arena_);
+  arena_vector<RoutingSchemeTuple> s_routing(arena_allocator);
+
   //run overlay maintenance
-  auto overlay_result = overlay_structure_scheme_.update(cur_round_, in_structure_.at(0));
-  gamma_agree_for_round_.push_front(overlay_result.gamma_agree);
+  const auto &overlay_result = overlay_structure_scheme_.update(cur_round_, inbox_.current().structure);
+  update_overlay_handles(overlay_result);
+  gamma_agree_for_round_.push_front(overlay_handles_.gamma_agree); // shared with previous rounds as long as unchanged
   if (gamma_agree_for_round_.size() > calculate_agreement_time(overlay_dimension_)) {
     gamma_agree_for_round_.pop_back(); // do store more than L_agreement entries
   }
-  auto &onid_emul_l_now = overlay_result.onid_emul;
-  auto &onid_emul_l_prev = onid_emul_;
-  onid_emul_ = onid_emul_l_now;
-  auto &out_structure = overlay_result.s_overlay_prime;
-  auto &gamma_route = overlay_result.gamma_route;
+  auto onid_emul_l_prev = onid_emul_;
+  onid_emul_ = overlay_result.onid_emul;
+  for (const auto &[i, messages] : overlay_result.s_overlay_prime) {
+    outbox_.for_peer(peer_registry_.intern(i)).structure = messages;
+  }
+  const auto &gamma_route = overlay_handles_.gamma_route;
+  traffic_out_recorder_.end_phase(TRAFFIC_OUT_PHASE_OVERLAY);
 
   //announce outgoing messages
-  while (!q_out_.empty() && q_out_.top().is_due(cur_round_, overlay_dimension_)) {
-    ocall_print_string("Announcing a message!\n");
-    for (auto &peer : overlay_result.gamma_send) {
-      out_announce[peer].emplace_back(q_out_.top());
-    }
-    q_out_.pop();
+  if (q_out_.pop_round(calculate_delivery_round(cur_round_, overlay_dimension_), q_out_due_) != 0) {
+    ocall_print_string("Discarded messages that were not announced in time ...\n");
+  }
+  if (!q_out_due_.empty()) {
+    ocall_print_string(("Announcing " + std::to_string(q_out_due_.size()) + " message(s)!\n").c_str());
+  }
+  for (auto peer : overlay_handles_.gamma_send) {
+    auto &announce = outbox_.for_peer(peer).announce;
+    announce.insert(announce.end(), q_out_due_.begin(), q_out_due_.end());
   }
+  traffic_out_recorder_.end_phase(TRAFFIC_OUT_PHASE_ANNOUNCE);
 
   // start agreement for (other nodes') outgoing messages
-  for (auto &announce: in_announce_[0]) {
+  auto start_agreement = [this](const MessageTuple &message, bool aware,
+                                const std::shared_ptr<const std::vector<peer_handle_t>> &participating_nodes,
+                                round_t round) {
+    if (!agreement_runs_.start(message, aware, participating_nodes, own_handle_, round)) {
+      ocall_print_string("Not part of gamma_agree, cannot take part in the agreement\n");
+    }
+  };
+  const auto &in = inbox_.current();
+  for (auto &announce: in.announce) {
     ocall_print_string("I received an announce message\n");
-    agreement_tuples_.emplace_back(AgreementLocalTuple{announce, true, DistributedAgreementScheme(),
-                                                       gamma_agree_for_round_.at(1), 0});
+    start_agreement(announce, true, gamma_agree_for_round_.at(1), 0);
   }
 
   // update running agreement schemes
-  for (auto &agreement: in_agreement_[0]) {
-    if (agreement.l < calculate_agreement_time(overlay_dimension_) - 1) {
-      bool found = false;
-      for (auto &elem: agreement_tuples_) {
-        if (elem.message == agreement.m) {
-          found = true;
-          break;
-        }
-      }
-      if (!found) {
-        agreement_tuples_.emplace_back(AgreementLocalTuple{agreement.m, false, DistributedAgreementScheme(),
-                                                           gamma_agree_for_round_.at(agreement.l), agreement.l - 1});
-      }
+  for (const auto &[message, agreement]: in.agreement) {
+    if (agreement.l < calculate_agreement_time(overlay_dimension_) - 1 && !agreement_runs_.contains(message)) {
+      start_agreement(message, false, gamma_agree_for_round_.at(agreement.l), agreement.l - 1);
     }
   }
-  for (auto &agreement_tuple: agreement_tuples_) {
-    // compute s_m
-    std::vector<PeerInformation> s_m;
-    for (auto &agreement_in: in_agreement_[0]) {
-      if (agreement_tuple.message == agreement_in.m) {
-        s_m.push_back(agreement_in.s);
-      }
+  // translate s_m (already grouped by message in traffic_in) to the participant set of an agreement run
+  auto s_m_of = [&](const MessageTuple &message, const AgreementLocalTuple &agreement_tuple) {
+    ParticipantSet s_m;
+    auto agreement_it = in.agreement.find(message);
+    if (agreement_it == in.agreement.end()) {
+      return s_m;
     }
-    // call update
-    auto new_agreement_messages = agreement_tuple.agreement_scheme.update(agreement_tuple.aware,
-                                                                          agreement_tuple.participating_nodes,
-                                                                          own_id_,
-                                                                          s_m,
-                                                                          agreement_tuple.round + 1);
-    // update tuple
-    agreement_tuple.round++;
-    // reset state
-    agreement_tuple.aware = false;
-    // add messages to out
-    for (auto &new_agreement_message : new_agreement_messages) {
-      out_agreement[new_agreement_message.receiver].emplace_back(AgreementTuple{agreement_tuple.message,
-                                                                                new_agreement_message.aware_node,
-                                                                                agreement_tuple.round + 1});
-    }
-  }
-
-  // finalize finished agreement scheme runs
-  for (auto &agreement_tuple : agreement_tuples_) {
-    if (agreement_tuple.round == calculate_agreement_time(overlay_dimension_) - 1) {
-      // compute s_m
-      std::vector<PeerInformation> s_m;
-      for (auto &agreement_in: in_agreement_[0]) {
-        if (agreement_tuple.message == agreement_in.m) {
-          s_m.push_back(agreement_in.s);
-        }
+    const auto &participating_nodes = *agreement_tuple.participating_nodes;
+    for (auto aware_node_id : agreement_it->second.s_m) {
+      auto aware_node = peer_registry_.find(aware_node_id);
+      auto position = DistributedAgreementScheme::position_of(participating_nodes, aware_node);
+      if (position < participating_nodes.size()) { // aware nodes that are no participants are ignored
+        s_m.set(position);
       }
-      // call finalize
-      bool v = agreement_tuple.agreement_scheme.finalize(own_id_, s_m, 0);
-      if (!v) {
-        continue; // v = 0, do nothing
+    }
+    return s_m;
+  };
+
+  agreement_runs_.update(s_m_of, [this](const MessageTuple &message,
+                                        const AgreementLocalTuple &agreement_tuple,
+                                        const DistributedAgreementSchemeOutput &new_agreement_messages) {
+    // add messages to out (one per receiver, carrying all aware nodes)
+    const auto &participating_nodes = *agreement_tuple.participating_nodes;
+    std::vector<uint64_t> aware_node_ids;
+    for (size_t aware_node = 0; aware_node < participating_nodes.size(); ++aware_node) {
+      if (new_agreement_messages.aware_nodes.test(aware_node)) {
+        aware_node_ids.push_back(peer_registry_.at(participating_nodes[aware_node]).id);
       }
-      // deletion see below
-      // decrypt
-      auto onid_src = decrypt_pseudonym(agreement_tuple.message.n_src).get_onid_repr();
-      for (auto &id: gamma_route.at(onid_src)) {
-        out_inject[id].emplace_back(agreement_tuple.message);
+    }
+    for (size_t receiver = 0; receiver < participating_nodes.size(); ++receiver) {
+      if (new_agreement_messages.receivers.test(receiver)) {
+        outbox_.for_peer(participating_nodes[receiver]).agreement.emplace_back(AgreementTuple{message,
+                                                                                              aware_node_ids,
+                                                                                              agreement_tuple.round
+                                                                                                  + 1});
       }
     }
-  }
-  // remove the tuples of the current round (did not do this during the loop for performance reasons)
-  auto it = std::remove_if(agreement_tuples_.begin(), agreement_tuples_.end(),
-                           [this](const AgreementLocalTuple &agreement_tuple) {
-                             return agreement_tuple.round == calculate_agreement_time(overlay_dimension_);
-                           });
+  });
 
-  agreement_tuples_.erase(it, agreement_tuples_.end());
+  traffic_out_recorder_.end_phase(TRAFFIC_OUT_PHASE_AGREEMENT_UPDATE);
 
+  // finalize finished agreement scheme runs and remove the runs that were finalized in the previous round
+  agreement_runs_.finalize(calculate_agreement_time(overlay_dimension_), s_m_of,
+                           [&](const MessageTuple &message, bool v) {
+    if (!v) {
+      return;
+    }
+    auto n_src_decr = decrypt_pseudonym(message.n_src);
+    if (n_src_decr) { // (dummys cannot be decrypted)
+      auto onid_src = n_src_decr->get_onid_repr();
+      for (auto id: gamma_route.at(onid_src)) {
+        outbox_.for_peer(id).inject.emplace_back(message);
+      }
+    }
+  });
+  traffic_out_recorder_.end_phase(TRAFFIC_OUT_PHASE_AGREEMENT_FINALIZE);
 
   // inject (other nodes') message into routing
-  auto in_inject_filtered = obtain_elements_that_exceed_m_corrupt<MessageTuple>(in_inject_[0]);
+  auto in_inject_filtered = obtain_elements_that_exceed_m_corrupt<MessageTuple>(in.inject);
 
-  for (const auto &inject_message : in_inject_filtered) {
+  for (const auto *inject_message_ptr : in_inject_filtered) {
+    const auto &inject_message = *inject_message_ptr;
     if (inject_message.is_dummy()) {
       continue; // ignore this message
     }
-    auto onid_dst = decrypt_pseudonym(inject_message.n_dst).get_onid_repr();
-    auto onid_src = decrypt_pseudonym(inject_message.n_src).get_onid_repr();
+    auto n_dst_decr = decrypt_pseudonym(inject_message.n_dst);
+    auto n_src_decr = decrypt_pseudonym(inject_message.n_src);
+    if (!n_dst_decr || !n_src_decr) {
+      ocall_print_string("Ignoring an injected message with an invalid pseudonym\n");
+      continue;
+    }
+    auto onid_dst = n_dst_decr->get_onid_repr();
+    auto onid_src = n_src_decr->get_onid_repr();
     s_routing.emplace_back(RoutingSchemeTuple{inject_message,
                                               onid_dst,
                                               inject_message.n_dst,
@@ -337,137 +408,144 @@ int ClientEnclave::traffic_out() {
                                               onid_src
     });
   }
+  traffic_out_recorder_.end_phase(TRAFFIC_OUT_PHASE_INJECT);
 
   // route messages
   auto s_primes =
       obtain_elements_that_exceed_m_corrupt<std::vector<RoutingSchemeTuple>>(
-          in_routing_[0]);
-  std::vector<RoutingSchemeTuple> v_set;
-  for (const auto &s_uppercase : s_primes) {
-    for (const auto &s_lowercase : s_uppercase) {
-      v_set.push_back(s_lowercase);
+          in.routing);
+  arena_vector<const RoutingSchemeTuple *> v_set(arena_allocator);
+  for (const auto *s_uppercase : s_primes) {
+    for (const auto &s_lowercase : *s_uppercase) {
+      v_set.push_back(&s_lowercase);
     }
   }
-  for (const auto &v : v_set) {
-    if (v.l_dst < cur_round_) {
-      s_routing.push_back(v);
+  for (const auto *v : v_set) {
+    if (v->l_dst < cur_round_) {
+      s_routing.push_back(*v);
     }
   }
   auto s_routing_prime = RoutingScheme::route(s_routing, cur_round_, overlay_dimension_, sk_routing_);
   for (const auto &[onid, peers] : gamma_route) {
-    for (const auto &i : peers) {
-      std::vector<RoutingSchemeTuple> s_prime_onid_current;
-      auto it = std::copy_if(s_routing_prime.begin(), s_routing_prime.end(), std::back_inserter(s_prime_onid_current),
-                             [&](const auto elem) { return elem.onid_current == onid; });
-      ASSERT (out_routing.count(i) == 0);
-      out_routing[i] = s_prime_onid_current;
-    }
+    auto &s_prime_onid_current = out_routing[onid];
+    std::copy_if(s_routing_prime.begin(), s_routing_prime.end(), std::back_inserter(s_prime_onid_current),
+                 [&](const auto &elem) { return elem.onid_current == onid; });
   }
+  traffic_out_recorder_.end_phase(TRAFFIC_OUT_PHASE_ROUTING);
 
   // run pre-delivery majority vote
-  for (const auto &v : v_set) {
-    if (v.l_dst == cur_round_) {
-      for (const auto &i : gamma_route[onid_emul_l_prev])
-        out_predeliver[i].emplace_back(v.m);
+  for (const auto *v : v_set) {
+    if (v->l_dst == cur_round_) {
+      out_predeliver.emplace_back(v->m);
     }
   }
 
   // deliver messages to final destination
   auto set_of_predeliver_messages = obtain_elements_that_exceed_m_corrupt<MessageTuple>(
-      in_predeliver_[0]);
-  for (const auto &message : set_of_predeliver_messages) {
-    if (!message.is_dummy()) {
-      out_deliver[decrypt_pseudonym(message.n_dst).get_peer_information()].emplace_back(message);
+      in.predeliver);
+  for (const auto *message : set_of_predeliver_messages) {
+    if (message->is_dummy()) {
+      continue;
+    }
+    auto n_dst_decr = decrypt_pseudonym(message->n_dst);
+    if (n_dst_decr) {
+      auto i = peer_registry_.intern(n_dst_decr->get_peer_information());
+      outbox_.for_peer(i).deliver.emplace_back(*message);
     }
   }
+  traffic_out_recorder_.end_phase(TRAFFIC_OUT_PHASE_DELIVERY);
 
   // add dummy messages
-  for (const auto &i : overlay_result.gamma_send) { // announce type
-    ASSERT (out_announce[i].size() <= kSend * kAMax);
-    out_announce[i].reserve(kSend * kAMax);
-    while (out_announce[i].size() < kSend * kAMax) {
-      out_announce[i].emplace_back(MessageTuple::create_dummy());
+  for (auto i : overlay_handles_.gamma_send) { // announce type
+    auto &out_announce_i = outbox_.for_peer(i).announce;
+    ASSERT (out_announce_i.size() <= kSend * kAMax);
+    out_announce_i.reserve(kSend * kAMax);
+    while (out_announce_i.size() < kSend * kAMax) {
+      out_announce_i.emplace_back(MessageTuple::create_dummy());
     }
   }
 
-  for (const auto&[onid, ids] : overlay_result.gamma_route) { // routing type
-    for (const auto &i : ids) {
-      ASSERT (out_routing[i].size() <= max_routing_msg_out_);
-      out_routing[i].reserve(max_routing_msg_out_);
-      while (out_routing[i].size() < max_routing_msg_out_) {
-        out_routing[i].emplace_back(RoutingSchemeTuple::create_dummy());
-      }
+  for (const auto &[onid, peers] : gamma_route) { // routing type
+    auto &s_prime_onid_current = out_routing[onid];
+    ASSERT (s_prime_onid_current.size() <= max_routing_msg_out_);
+    s_prime_onid_current.reserve(max_routing_msg_out_);
+    while (s_prime_onid_current.size() < max_routing_msg_out_) {
+      s_prime_onid_current.emplace_back(RoutingSchemeTuple::create_dummy());
     }
   }
 
-  for (const auto &i : overlay_result.gamma_route[onid_emul_l_prev]) { // predeliver type
-    ASSERT (out_predeliver[i].size() <= kRecv * kAMax * overlay_result.gamma_receive.size());
-    out_predeliver[i].reserve(kRecv * kAMax * overlay_result.gamma_receive.size());
-    while (out_predeliver[i].size() < kRecv * kAMax * overlay_result.gamma_receive.size()) {
-      out_predeliver[i].emplace_back(MessageTuple::create_dummy());
+  if (gamma_route.count(onid_emul_l_prev) != 0) { // predeliver type
+    ASSERT (out_predeliver.size() <= kRecv * kAMax * overlay_result.gamma_receive.size());
+    out_predeliver.reserve(kRecv * kAMax * overlay_result.gamma_receive.size());
+    while (out_predeliver.size() < kRecv * kAMax * overlay_result.gamma_receive.size()) {
+      out_predeliver.emplace_back(MessageTuple::create_dummy());
     }
   }
 
-  for (const auto &i : overlay_result.gamma_receive) { // deliver type
-    ASSERT (out_deliver[i].size() <= kRecv * kAMax);
-    out_deliver[i].reserve(kRecv * kAMax);
-    while (out_deliver[i].size() < kRecv * kAMax) {
-      out_deliver[i].emplace_back(MessageTuple::create_dummy());
+  for (auto i : overlay_handles_.gamma_receive) { // deliver type
+    auto &out_deliver_i = outbox_.for_peer(i).deliver;
+    ASSERT (out_deliver_i.size() <= kRecv * kAMax);
+    out_deliver_i.reserve(kRecv * kAMax);
+    while (out_deliver_i.size() < kRecv * kAMax) {
+      out_deliver_i.emplace_back(MessageTuple::create_dummy());
     }
   }
+  traffic_out_recorder_.end_phase(TRAFFIC_OUT_PHASE_PADDING);
 
-  // encrypt and authenticate outgoing data
-  std::vector<PeerInformation>
-      all_i; // since there was a bug whose source I could not determine, we have to use vector instead of set here.. set simply didn't guarantee uniqueness
-  add_peer_information_to_set_if_not_present(all_i, out_announce);
-  add_peer_information_to_set_if_not_present(all_i, out_agreement);
-  add_peer_information_to_set_if_not_present(all_i, out_inject);
-  add_peer_information_to_set_if_not_present(all_i, out_routing);
-  add_peer_information_to_set_if_not_present(all_i, out_predeliver);
-  add_peer_information_to_set_if_not_present(all_i, out_deliver);
-  add_peer_information_to_set_if_not_present(all_i, out_structure);
+  // serialize the routing and predeliver parts once per quorum (they are the same for all nodes of a quorum)
+  const std::vector<MessageTuple> no_predeliver;
+  for (const auto &[onid, peers] : gamma_route) {
+    auto &shared_segment = outbox_.shared_segment_for_quorum[onid];
+    serialize_vec(shared_segment, out_routing[onid]);
+    serialize_vec(shared_segment, onid == onid_emul_l_prev ? out_predeliver : no_predeliver);
+    for (auto i : peers) {
+      auto &record = outbox_.for_peer(i);
+      ASSERT (record.shared_segment == nullptr);
+      record.shared_segment = &shared_segment;
+    }
+  }
+  std::vector<uint8_t> empty_shared_segment; // for nodes that are not part of any routing quorum
+  serialize_vec(empty_shared_segment, std::vector<RoutingSchemeTuple>());
+  serialize_vec(empty_shared_segment, std::vector<MessageTuple>());
 
+  // encrypt and authenticate outgoing data (for every peer with an entry in any of the out sets)
   std::vector<ReceiverBlobPair> i_c_pairs;
-  for (auto &i : all_i) {
-    // compute p_i
-    std::vector<uint8_t> p_i_serialized;
-
-    serialize_vec(p_i_serialized, out_announce[i]);
-    serialize_vec(p_i_serialized, out_agreement[i]);
-    serialize_vec(p_i_serialized, out_inject[i]);
-    serialize_vec(p_i_serialized, out_routing[i]);
-    serialize_vec(p_i_serialized, out_predeliver[i]);
-    serialize_vec(p_i_serialized, out_deliver[i]);
-
-    // compute aad_i
-    auto aad_i = AadTuple{own_id_, i, cur_round_ + 1, out_structure[i]};
-    std::vector<uint8_t> aad_i_serialized;
+  i_c_pairs.reserve(outbox_.receivers().size());
+  size_t per_node_size_hint = 0;
+  std::vector<uint8_t> p_i_serialized; // the buffers are reused for all receivers
+  std::vector<uint8_t> aad_i_serialized;
+  for (auto i : outbox_.receivers()) {
+    const auto &record = outbox_.at(i);
+    const auto &shared_segment = record.shared_segment != nullptr ? *record.shared_segment : empty_shared_segment;
+
+    // compute p_i (only the per-node parts are serialized here, the shared segment is copied)
+    p_i_serialized.clear();
+    p_i_serialized.reserve(shared_segment.size() + per_node_size_hint);
+
+    serialize_vec(p_i_serialized, record.announce);
+    serialize_vec(p_i_serialized, record.agreement);
+    serialize_vec(p_i_serialized, record.inject);
+    p_i_serialized.insert(p_i_serialized.end(), shared_segment.begin(), shared_segment.end());
+    serialize_vec(p_i_serialized, record.deliver);
+    per_node_size_hint = std::max(per_node_size_hint, p_i_serialized.size() - shared_segment.size());
+
+    // compute aad_i (the PeerInformation is only needed from here on)
+    const auto &peer_i = peer_registry_.at(i);
+    auto aad_i = AadTuple{own_id_, peer_i, cur_round_ + 1, record.structure};
+    aad_i_serialized.clear();
     aad_i.serialize(aad_i_serialized);
 
     // compute c_i
-    i_c_pairs.emplace_back(ReceiverBlobPair{i, cryptlib::encrypt(sk_enc_, p_i_serialized, aad_i_serialized)});
+    i_c_pairs.emplace_back(ReceiverBlobPair{peer_i, cryptlib::encrypt(sk_enc_, p_i_serialized, aad_i_serialized)});
   }
 
   std::vector<uint8_t> output;
   serialize_vec(output, i_c_pairs);
+  traffic_out_recorder_.end_phase(TRAFFIC_OUT_PHASE_SEALING);
 
-  // move all in[1] to in[0]
-  in_structure_[0] = std::move(in_structure_[1]);
-  in_structure_[1].clear();
-  in_announce_[0] = std::move(in_announce_[1]);
-  in_announce_[1].clear();
-  in_agreement_[0] = std::move(in_agreement_[1]);
-  in_agreement_[1].clear();
-  in_inject_[0] = std::move(in_inject_[1]);
-  in_inject_[1].clear();
-  in_routing_[0] = std::move(in_routing_[1]);
-  in_routing_[1].clear();
-  in_predeliver_[0] = std::move(in_predeliver_[1]);
-  in_predeliver_[1].clear();
-  in_deliver_[0] = std::move(in_deliver_[1]);
-  in_deliver_[1].clear();
-  traffic_in_received_from_[0] = std::move(traffic_in_received_from_[1]);
-  traffic_in_received_from_[1].clear();
+  // the next round becomes the current one
+  inbox_.advance();
+  traffic_out_recorder_.end_phase(TRAFFIC_OUT_PHASE_INBOX_ROTATION);
 
   // actually return the output
   sgx_status_t ret = ocall_traffic_out_return(output.data(), output.size());
@@ -480,8 +558,14 @@ int ClientEnclave::traffic_out() {
       }
     }
   }
-
-  ocall_print_string("\n");
+  traffic_out_recorder_.end_phase(TRAFFIC_OUT_PHASE_OUTPUT);
+  traffic_out_recorder_.end_round(cur_round_);
+#ifndef NDEBUG
+  const auto &arena_stats = round_arena_.stats();
+  traffic_out_recorder_.set_arena(traffic_out_arena_stats_t{arena_stats.allocations,
+                                                            std::max(arena_stats.peak_bytes, arena_stats.bytes),
+                                                            arena_stats.heap_blocks});
+#endif
 
   return true;
 }
@@ -491,86 +575,135 @@ void ClientEnclave::traffic_in(const uint8_t *ptr, size_t len) {
     return;
   }
 
-  // decrypt data
-  std::vector<uint8_t> data;
-  data.insert(data.end(), ptr, ptr + len);
-  auto[p_decrypted, aad_decrypted] = cryptlib::decrypt(sk_enc_, data);
-  if (p_decrypted.size() == 0 && aad_decrypted.size() == 0) {
-    ocall_print_string("Decrypted message is empty!\n");
+  traffic_in_stats_.received_messages++;
+  traffic_in_stats_.received_bytes += len;
+  auto reject = [this, len](uint64_t &counter, bool decrypted, const char *reason) {
+    counter++;
+    traffic_in_stats_.rejected_bytes += len;
+    if (!decrypted) {
+      traffic_in_stats_.rejected_bytes_undecrypted += len;
+    }
+    ocall_print_string(reason);
+  };
+
+  // pre-validation: the header of the aad is checked before the (expensive) decryption and deserialization. As it is
+  // not authenticated yet, it is only used to reject messages, all state is updated after the decryption succeeded.
+  cryptlib::CiphertextRanges ranges;
+  if (!cryptlib::get_ranges(ptr, len, ranges) || ranges.aad_len < AadTuple::kHeaderSize) {
+    reject(traffic_in_stats_.rejected_malformed, false, "Received a malformed message ...\n");
     return;
   }
-
-  // deserialize aad
+  PeerInformation sender, receiver;
+  round_t round;
   size_t cur_aad = 0;
-  auto aad = AadTuple::deserialize(aad_decrypted, cur_aad);
-
-  // deserialize p
-  size_t cur_p = 0;
-  auto p_announce = deserialize_vec<MessageTuple>(p_decrypted, cur_p);
-  auto p_agreement = deserialize_vec<AgreementTuple>(p_decrypted, cur_p);
-  auto p_inject = deserialize_vec<MessageTuple>(p_decrypted, cur_p);
-  auto p_routing = deserialize_vec<RoutingSchemeTuple>(p_decrypted, cur_p);
-  auto p_predeliver = deserialize_vec<MessageTuple>(p_decrypted, cur_p);
-  auto p_deliver = deserialize_vec<MessageTuple>(p_decrypted, cur_p);
-
-  if (aad.receiver != own_id_) {
-    ocall_print_string("Received a misguided message ...\n");
+  traffic_in_buffer_.assign(ptr + ranges.aad_begin, ptr + ranges.aad_begin + AadTuple::kHeaderSize);
+  AadTuple::deserialize_header(traffic_in_buffer_, cur_aad, sender, receiver, round);
+
+  if (receiver != own_id_) {
+    reject(traffic_in_stats_.rejected_misaddressed, false, "Received a misguided message ...\n");
     return; // message was misguided
   }
 
-  if (aad.round < cur_round_) {
-    ocall_print_string("Received a message that was sent too late ...\n");
+  if (round < cur_round_) {
+    reject(traffic_in_stats_.rejected_stale, false, "Received a message that was sent too late ...\n");
     return;
   }
 
-  auto cur_or_next = aad.round - cur_round_; // compute whether in[0] or in[1] needs to be used
-  ASSERT(cur_or_next < 2);
+  auto cur_or_next = round - cur_round_; // compute whether the slot of the current or the next round is used
+  if (cur_or_next >= Inbox::kNumRounds) {
+    reject(traffic_in_stats_.rejected_early, false, "Received a message for a future round ...\n");
+    return;
+  }
+  auto &in = inbox_.for_round(cur_or_next);
 
-  if (traffic_in_received_from_[cur_or_next][aad.sender]) {
-    ocall_print_string("Received a message a second time ...\n");
+  auto sender_handle = peer_registry_.find(sender.id);
+  if (sender_handle != PeerRegistry::kNoPeer && in.received_from.count(sender_handle) != 0) {
     // possible replay attack (message was already received)
+    reject(traffic_in_stats_.rejected_replayed, false, "Received a message a second time ...\n");
     return;
   }
 
-  traffic_in_received_from_[cur_or_next][aad.sender] = true;
-
-  in_announce_[cur_or_next].insert(std::end(in_announce_[cur_or_next]), std::begin(p_announce), std::end(p_announce));
-  in_agreement_[cur_or_next].insert(std::end(in_agreement_[cur_or_next]),
-                                    std::begin(p_agreement),
-                                    std::end(p_agreement));
-  in_inject_[cur_or_next].insert(std::end(in_inject_[cur_or_next]), std::begin(p_inject), std::end(p_inject));
-  in_routing_[cur_or_next].push_back(std::move(p_routing));
-  in_predeliver_[cur_or_next].insert(std::end(in_predeliver_[cur_or_next]),
-                                     std::begin(p_predeliver),
-                                     std::end(p_predeliver));
-  in_structure_[cur_or_next].insert(std::end(in_structure_[cur_or_next]),
-                                    std::begin(aad.p_structure),
-                                    std::end(aad.p_structure));
-  in_deliver_[cur_or_next].insert(std::begin(p_deliver),
-                                  std::end(p_deliver));
-
-  // remove dummys from routing
-  auto it = std::remove_if(in_routing_[cur_or_next].begin(), in_routing_[cur_or_next].end(),
-                           [this](const std::vector<RoutingSchemeTuple> &routing_vec) {
-                             return routing_vec.size() == 0;
-                           });
-
-  in_routing_[cur_or_next].erase(it, in_routing_[cur_or_next].end());
+  // decrypt data (in place, within a buffer that is reused for all calls)
+  traffic_in_buffer_.assign(ptr, ptr + len);
+  if (!cryptlib::decrypt_in_place(sk_enc_, traffic_in_buffer_, ranges)) {
+    reject(traffic_in_stats_.rejected_unauthenticated, true, "Received a message that could not be decrypted ...\n");
+    return;
+  }
+  const auto &data = traffic_in_buffer_;
+  in.received_from.insert(peer_registry_.intern(sender));
+  traffic_in_stats_.accepted_messages++;
+
+  // the remainder of the aad (the header has been authenticated now)
+  size_t cur_structure = ranges.aad_begin + AadTuple::kHeaderSize;
+  auto p_structure = deserialize_vec<OverlayStructureSchemeMessage>(data, cur_structure);
+  ASSERT(cur_structure == ranges.aad_begin + ranges.aad_len);
+
+  // deserialize p straight into the inbox (dummys are skipped without being deserialized, except for announces:
+  // every announce starts an agreement run, so that the agreement output does not depend on the number of dummys)
+  size_t cur_p = ranges.p_begin;
+  auto append_to = [](auto &set) {
+    return [&set](auto &&elem) { set.insert(set.end(), std::move(elem)); };
+  };
+  deserialize_vec_each<MessageTuple>(data, cur_p, append_to(in.announce));
+  deserialize_vec_each<AgreementTuple>(data, cur_p, [&in](AgreementTuple &&agreement) {
+    // expand the aggregated agreement messages into s_m
+    auto &agreement_inbox_entry =
+        in.agreement.try_emplace(agreement.m, AgreementInboxEntry{agreement.l, {}}).first->second;
+    agreement_inbox_entry.s_m.insert(agreement_inbox_entry.s_m.end(), agreement.s.begin(), agreement.s.end());
+  });
+  deserialize_vec_each<MessageTuple>(data, cur_p, append_to(in.inject), MessageTuple::skip_dummy);
+  std::vector<RoutingSchemeTuple> p_routing;
+  deserialize_vec_each<RoutingSchemeTuple>(data, cur_p, append_to(p_routing), RoutingSchemeTuple::skip_dummy);
+  if (!p_routing.empty()) { // the routing sets of different senders are compared as a whole, thus kept separately
+    in.routing.push_back(std::move(p_routing));
+  }
+  deserialize_vec_each<MessageTuple>(data, cur_p, append_to(in.predeliver), MessageTuple::skip_dummy);
+  deserialize_vec_each<MessageTuple>(data, cur_p, append_to(in.deliver), MessageTuple::skip_dummy);
+  ASSERT(cur_p == ranges.p_begin + ranges.p_len);
+  in.structure.insert(std::end(in.structure),
+                      std::make_move_iterator(std::begin(p_structure)),
+                      std::make_move_iterator(std::end(p_structure)));
 
   // deliver message
-  if (traffic_in_received_from_[cur_or_next].size() > m_corrupt_) {
-    for (auto &message : in_deliver_[cur_or_next]) {
-      if (!message.is_dummy()) {
-        q_in_for_pseudonyms_.at(decrypt_pseudonym(message.n_dst).get_local_num()).push(std::move(message));
+  if (in.received_from.size() > m_corrupt_) {
+    struct Delivery {
+      uint64_t num_messages = 0;
+      uint64_t first_t_dst = std::numeric_limits<uint64_t>::max();
+    };
+    std::vector<Delivery> deliveries(pseudonyms_.size());
+    for (auto &message : in.deliver) {
+      if (message.is_dummy()) {
+        continue;
+      }
+      auto pseud_n_dst = decrypt_pseudonym(message.n_dst);
+      if (pseud_n_dst && is_local_pseudonym(*pseud_n_dst)) {
+        q_in_for_pseudonyms_.push(pseud_n_dst->get_local_num(), message);
+        auto &delivery = deliveries[pseud_n_dst->get_local_num()];
+        delivery.num_messages++;
+        delivery.first_t_dst = std::min(delivery.first_t_dst, message.t_dst);
+      }
+    }
+    // notify the untrusted part (once per pseudonym), so that it does not have to poll receive_messages
+    auto now = get_time();
+    for (size_t local_num = 0; local_num < deliveries.size(); ++local_num) {
+      const auto &delivery = deliveries[local_num];
+      if (delivery.num_messages != 0) {
+        ocall_messages_delivered(static_cast<uint8_t>(local_num), delivery.num_messages,
+                                 delivery.first_t_dst > now ? delivery.first_t_dst - now : 0);
       }
     }
     // empty the sets - the if condition will never be fulfilled for this round again
-    in_deliver_[cur_or_next].clear();
-    traffic_in_received_from_[cur_or_next].clear();
+    in.deliver.clear();
+    in.received_from.clear();
   }
   ocall_print_string("\n");
 }
 
+bool ClientEnclave::is_local_pseudonym(const DecryptedPseudonym &pseudonym) const {
+  auto local_num = pseudonym.get_local_num();
+  return local_num < pseudonyms_.size() && pseudonyms_[local_num] == pseudonym;
+}
+
 uint64_t ClientEnclave::get_time() const {
   if (!initialized_) {
     return 0;
@@ -583,46 +716,48 @@ uint64_t ClientEnclave::get_time() const {
   return current_time - init_time_;
 }
 
-DecryptedPseudonym ClientEnclave::decrypt_pseudonym(const c1::client::Pseudonym &pseudonym) const {
-  std::vector<uint8_t> pseud_vec(pseudonym.get().data(), pseudonym.get().data() + pseudonym.get().size());
-  auto pseud_decr = cryptlib::decrypt(sk_pseud_, pseud_vec);
-
-  size_t cur = 0;
-  return DecryptedPseudonym::deserialize(pseud_decr.first, cur);
+uint64_t ClientEnclave::untrusted_time_ns() {
+  uint64_t result = 0;
+  if (ocall_get_time_ns(&result) != SGX_SUCCESS) {
+    return 0;
+  }
+  return result;
 }
 
-template<typename T>
-std::vector<T> ClientEnclave::obtain_elements_that_exceed_m_corrupt(const std::vector<T> &vec) const {
-  std::map<T, int> elems_u_counter;
-  for (const auto &elem_t : vec) {
-    if (elems_u_counter.count(elem_t) == 0) {
-      elems_u_counter[elem_t] = 0;
-    }
-    elems_u_counter[elem_t]++;
+void ClientEnclave::update_overlay_handles(const OverlayReturnTuple &overlay_result) {
+  if (overlay_handles_.version == overlay_result.version) {
+    return;
   }
+  if (overlay_result.gamma_agree->size() > kMaxAgreementParticipants) {
+    // the agreement runs cannot represent that many participants, and the enclave must not continue without them
+    ocall_print_string("gamma_agree exceeds the maximal number of agreement participants, aborting\n");
+    abort();
+  }
+  overlay_handles_.version = overlay_result.version;
+  overlay_handles_.gamma_agree =
+      std::make_shared<const std::vector<peer_handle_t>>(peer_registry_.intern(*overlay_result.gamma_agree));
+  overlay_handles_.gamma_send = peer_registry_.intern(overlay_result.gamma_send);
+  overlay_handles_.gamma_route.clear();
+  for (const auto &[onid, peers] : overlay_result.gamma_route) {
+    overlay_handles_.gamma_route.emplace_hint(overlay_handles_.gamma_route.end(), onid, peer_registry_.intern(peers));
+  }
+  overlay_handles_.gamma_receive = peer_registry_.intern(overlay_result.gamma_receive);
+}
 
-  std::vector<T> result;
-
-  for (const auto &elem_u : elems_u_counter) {
-    if (elem_u.second > m_corrupt_) {
-      result.push_back(elem_u.first);
-    }
+std::optional<DecryptedPseudonym> ClientEnclave::decrypt_pseudonym(const c1::client::Pseudonym &pseudonym) const {
+  std::vector<uint8_t> pseud_vec(pseudonym.get().data(), pseudonym.get().data() + pseudonym.get().size());
+  std::vector<uint8_t> p, aad;
+  if (!cryptlib::decrypt(sk_pseud_, pseud_vec, p, aad)) {
+    return std::nullopt;
   }
 
-  return result;
+  size_t cur = 0;
+  return DecryptedPseudonym::deserialize(p, cur);
 }
 
 template<typename T>
-void ClientEnclave::add_peer_information_to_set_if_not_present(std::vector<PeerInformation> &result,
-                                                               const std::map<PeerInformation, T> &map) const {
-  for (const auto &elem : map) {
-    if (std::find(result.begin(), result.end(), elem.first) != result.end()) {
-      //ocall_print_string(("Trying to insert " + std::string(elem.first) + " again... I won't do this.\n").c_str());
-    } else {
-      result.push_back(elem.first);
-    }
-  }
-
+arena_vector<const T *> ClientEnclave::obtain_elements_that_exceed_m_corrupt(const std::vector<T> &vec) {
+  return c1::client::obtain_elements_that_exceed_m_corrupt(vec, m_corrupt_, round_arena_);
 }
 
 } // ~namespace
@@ -647,6 +782,13 @@ void ecall_generate_pseudonym(uint8_t pseudonym[kPseudonymSize]) {
   c1::client::ClientEnclave::instance().generate_pseudonym(pseudonym);
 }
 
+size_t ecall_send_messages(injection_command_t *commands, size_t num_commands) {
+  static_assert(sizeof(injection_command_t) == sizeof(c1::UserInterfaceMessageInjectionCommand),
+                "injection_command_t and UserInterfaceMessageInjectionCommand have to be of the same layout");
+  return c1::client::ClientEnclave::instance().send_messages(
+      reinterpret_cast<const c1::UserInterfaceMessageInjectionCommand *>(commands), num_commands);
+}
+
 void ecall_send_message(uint8_t n_src[kPseudonymSize],
                         uint8_t msg[kMessageSize],
                         uint8_t n_dst[kPseudonymSize],
@@ -661,6 +803,16 @@ int ecall_receive_message(uint8_t n_dst[kPseudonymSize],
   return c1::client::ClientEnclave::instance().receive_message(n_dst, msg, n_src, t_dst);
 }
 
+size_t ecall_receive_messages(uint8_t n_dst[kPseudonymSize], received_message_t *messages, size_t max_messages) {
+  const auto &result = c1::client::ClientEnclave::instance().receive_messages(n_dst, max_messages);
+  for (size_t i = 0; i < result.size(); ++i) {
+    std::copy(result[i].m.get().begin(), result[i].m.get().end(), messages[i].msg);
+    std::copy(result[i].n_src.get().begin(), result[i].n_src.get().end(), messages[i].n_src);
+    messages[i].t_dst = result[i].t_dst;
+  }
+  return result.size();
+}
+
 int ecall_traffic_out() {
   return c1::client::ClientEnclave::instance().traffic_out();
 }
@@ -669,6 +821,14 @@ void ecall_traffic_in(const uint8_t *ptr, size_t len) {
   c1::client::ClientEnclave::instance().traffic_in(ptr, len);
 }
 
+void ecall_get_traffic_in_stats(traffic_in_stats_t *stats) {
+  *stats = c1::client::ClientEnclave::instance().traffic_in_stats();
+}
+
+void ecall_get_traffic_out_stats(traffic_out_stats_t *stats) {
+  *stats = c1::client::ClientEnclave::instance().traffic_out_stats();
+}
+
 uint64_t ecall_get_time() {
   return c1::client::ClientEnclave::instance().get_time();
 }
@@ -3,12 +3,24 @@
 
 
 #include <string>
-#include <queue>
 #include <set>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
 #include <sgx_tcrypto.h>
 #include "../../include/shared_structs.h"
 #include "overlay_structure_scheme.h"
 #include "structures.h"
+#include "structures/peer_registry.h"
+#include "structures/outbox.h"
+#include "structures/inbox.h"
+#include "structures/calendar_queue.h"
+#include "structures/pseudonym_inbox.h"
+#include "structures/agreement_runs.h"
+#include "round_arena.h"
+#include "m_corrupt_filter.h"
+#include "traffic_out_recorder.h"
+#include "../../include/enclave_stats.h"
 
 namespace c1::client {
 
@@ -20,7 +32,8 @@ class ClientEnclave {
   /**
    * Constructor. Not to be called directly (thus private). Use instance() instead.
    */
-  ClientEnclave() : overlay_structure_scheme_(), cur_round_(static_cast<round_t>(-1)) {
+  ClientEnclave()
+      : overlay_structure_scheme_(), traffic_out_recorder_(&untrusted_time_ns), cur_round_(static_cast<round_t>(-1)) {
   }
 
  public:
@@ -88,6 +101,13 @@ class ClientEnclave {
                     uint8_t msg[kMessageSize],
                     uint8_t n_dst[kPseudonymSize],
                     uint64_t t_dst);
+  /**
+   * send_message for a batch of messages: each distinct source pseudonym is decrypted and the time is read only once.
+   * @param commands
+   * @param num_commands
+   * @return the number of messages queued
+   */
+  size_t send_messages(const UserInterfaceMessageInjectionCommand *commands, size_t num_commands);
   /**
    * see paper
    * @param n_dst
@@ -100,6 +120,13 @@ class ClientEnclave {
                       uint8_t *msg,
                       uint8_t *n_src,
                       uint64_t *t_dst);
+  /**
+   * Takes out all due messages (ordered by t_dst) of pseudonym n_dst at once.
+   * @param n_dst
+   * @param max_messages
+   * @return the messages (valid until the next call), empty if n_dst is not a pseudonym of this node
+   */
+  const std::vector<MessageTuple> &receive_messages(uint8_t *n_dst, size_t max_messages);
   /**
    * see paper
    * @return true iff this call of traffic_out was not superfluous (it is necessary only once every round) and ran correctly
@@ -111,6 +138,14 @@ class ClientEnclave {
    * @param len
    */
   void traffic_in(const uint8_t *ptr, size_t len);
+  /** the counters of traffic_in */
+  const traffic_in_stats_t &traffic_in_stats() const {
+    return traffic_in_stats_;
+  }
+  /** the phase timers and counters of traffic_out */
+  const traffic_out_stats_t &traffic_out_stats() const {
+    return traffic_out_recorder_.stats();
+  }
   /**
    * retrieves the current time, relative to the initialization time
    * @return
@@ -118,6 +153,9 @@ class ClientEnclave {
   uint64_t get_time() const;
 
  private:
+  /** the clock of the traffic_out phase timers (steady time of the untrusted part in ns, 0 if the ocall fails) */
+  static uint64_t untrusted_time_ns();
+
   /** see paper */
   size_t m_corrupt_ = 1;
   /** see paper */
@@ -130,6 +168,10 @@ class ClientEnclave {
   onid_t onid_emul_;
   /** the pi of the peeritself */
   PeerInformation own_id_;
+  /** all peers known to this enclave, the per-peer data is indexed by the handles handed out by it */
+  PeerRegistry peer_registry_;
+  /** the handle of the peer itself */
+  peer_handle_t own_handle_;
   /** see paper */
   sgx_aes_gcm_128bit_key_t sk_pseud_;
   /** see paper */
@@ -137,10 +179,13 @@ class ClientEnclave {
   /** see paper */
   sgx_cmac_128bit_key_t sk_routing_;
   /** set q_in (see paper), one for each (of the local) pseudonym(s) */
-  std::vector<std::priority_queue<MessageTuple, std::vector<MessageTuple>, std::greater<MessageTuple>>>
-      q_in_for_pseudonyms_;
-  /** see paper */
-  std::priority_queue<MessageTuple, std::vector<MessageTuple>, std::greater<MessageTuple>> q_out_;
+  PseudonymInbox q_in_for_pseudonyms_;
+  /** the messages returned by receive_messages (kept to reuse its memory) */
+  std::vector<MessageTuple> received_messages_;
+  /** set q_out (see paper), by the round the messages are delivered in */
+  CalendarQueue<MessageTuple> q_out_;
+  /** the messages of q_out announced in the current round (kept to reuse its memory) */
+  std::vector<MessageTuple> q_out_due_;
   /** used to count the messages sent from each of the local pseudonyms for each round (to check if we respected the k_send limit) */
   std::vector<std::map<uint64_t, int>>
       num_q_out_entries_for_round_for_pseudonym_;
@@ -148,58 +193,70 @@ class ClientEnclave {
   std::vector<DecryptedPseudonym> pseudonyms_;
   /** basically, this is st_overlay */
   OverlayStructureScheme overlay_structure_scheme_;
-  /** set in for this tag - twice because we may receive messages for the next round and the round after (due to delay) */
-  std::array<std::vector<OverlayStructureSchemeMessage>, 2>
-      in_structure_;
-  /** set in for this tag - twice because we may receive messages for the next round and the round after (due to delay) */
-  std::array<std::vector<MessageTuple>, 2> in_announce_;
-  /** set in for this tag - twice because we may receive messages for the next round and the round after (due to delay) */
-  std::array<std::vector<AgreementTuple>, 2> in_agreement_;
-  /** set in for this tag - twice because we may receive messages for the next round and the round after (due to delay) */
-  std::array<std::vector<MessageTuple>, 2> in_inject_;
-  /** set in for this tag - twice because we may receive messages for the next round and the round after (due to delay) */
-  std::array<std::vector<std::vector<RoutingSchemeTuple>>, 2>
-      in_routing_;
-  /** set in for this tag - twice because we may receive messages for the next round and the round after (due to delay) */
-  std::array<std::vector<MessageTuple>, 2> in_predeliver_;
-  /** set in for this tag - twice because we may receive messages for the next round and the round after (due to delay) */
-  std::array<std::set<MessageTuple>, 2> in_deliver_;
+  /** the view of the overlay (see OverlayReturnTuple) with all peers replaced by their handles */
+  struct OverlayHandles {
+    uint64_t version = 0;
+    std::shared_ptr<const std::vector<peer_handle_t>> gamma_agree;
+    std::vector<peer_handle_t> gamma_send;
+    std::map<onid_t, std::vector<peer_handle_t>> gamma_route;
+    std::vector<peer_handle_t> gamma_receive;
+  } overlay_handles_;
+  /** the sets in for the current and the next round (we may receive messages for the next round due to delay) */
+  Inbox inbox_;
+  /** the data passed to traffic_in is decrypted within this buffer (kept to reuse its memory) */
+  std::vector<uint8_t> traffic_in_buffer_;
+  traffic_in_stats_t traffic_in_stats_{};
+  /** the out sets of traffic_out (reset every round) */
+  Outbox outbox_;
+  /** memory for the data used during one call of traffic_out only (reset every round) */
+  RoundArena round_arena_;
+  TrafficOutRecorder traffic_out_recorder_;
   /** the tuples to be stored for messages whose agreement protocol this TEE is currently part of */
-  std::vector<AgreementLocalTuple> agreement_tuples_;
+  AgreementRuns agreement_runs_;
   /** see paper (called l_now there) */
   round_t cur_round_;
   /** used to store gamma_{agree, l}, where entry 0 corresponds to l_now and entry l corresponds to l_now - l */
-  std::deque<std::vector<PeerInformation>>
+  std::deque<std::shared_ptr<const std::vector<peer_handle_t>>>
       gamma_agree_for_round_;
-  /** Used to ignore messages sent twice (to prevent replay attacks) */
-  std::array<std::map<PeerInformation, bool>, 2> traffic_in_received_from_;
+
+  /**
+   * Re-intern the overlay view if it has changed since the last call.
+   * @param overlay_result
+   */
+  void update_overlay_handles(const OverlayReturnTuple &overlay_result);
 
   /**
    * Decrypt a pseudonym to obtain the id of the node with that pseudonym and the onid of its associated quorum
    * @param pseudonym
-   * @return
+   * @return std::nullopt if pseudonym could not be decrypted (it is malformed, a dummy or was not created by the enclaves)
    */
-  DecryptedPseudonym decrypt_pseudonym(const Pseudonym &pseudonym) const;
+  std::optional<DecryptedPseudonym> decrypt_pseudonym(const Pseudonym &pseudonym) const;
+  /** whether pseudonym is one of the pseudonyms of this node (looked up by its local number) */
+  bool is_local_pseudonym(const DecryptedPseudonym &pseudonym) const;
 
+  /** the outcome of queue_message */
+  enum SendResult { kQueued, kUnknownSource, kTooLate, kLimitExceeded, kNumSendResults };
   /**
-   * For a given vector v of elements of type T, return those elements that occur more than m_corrupt times in v
+   * Adds a message to q_out if n_src is a local pseudonym, the message can still reach its destination in time and
+   * n_src has not sent kSend messages for that round yet.
+   * @param n_src_decr n_src decrypted
+   * @param now the current time
+   */
+  SendResult queue_message(const DecryptedPseudonym &n_src_decr,
+                           const Pseudonym &n_src,
+                           const Message &msg,
+                           const Pseudonym &n_dst,
+                           uint64_t t_dst,
+                           uint64_t now);
+
+  /**
+   * see obtain_elements_that_exceed_m_corrupt in m_corrupt_filter.h (with m_corrupt_ and the round arena)
    * @tparam T Type of the elements in the vector
    * @param vec The input vector
-   * @return a vector containing only the desired elements (and only once)
+   * @return pointers to the desired elements within vec (each element only once), allocated from the round arena
    */
   template<typename T>
-  std::vector<T> obtain_elements_that_exceed_m_corrupt(const std::vector<T> &vec) const;
-  template<typename T>
-  /**
-   * Traverses map and adds all keys to result that aren't in there already (used to be a set, but there seems to be a bug in the stdlib causing elements not to be unique)
-   * @tparam T
-   * @param result
-   * @param map
-   */
-  void add_peer_information_to_set_if_not_present(std::vector<PeerInformation>
-                                                  &result,
-                                                  const std::map<PeerInformation, T> &map
-  ) const;
+  arena_vector<const T *> obtain_elements_that_exceed_m_corrupt(const std::vector<T> &vec);
 };
 
 } // !namespace
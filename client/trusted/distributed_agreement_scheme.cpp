@@ -2,6 +2,7 @@
 // Created by c1 on 06.05.18.
 //
 
+#include <algorithm>
 #include "distributed_agreement_scheme.h"
 
 namespace c1::client {
@@ -10,39 +11,49 @@ DistributedAgreementScheme::DistributedAgreementScheme() : set_s_i_() {
 
 }
 
-std::vector<DistributedAgreementSchemePair> DistributedAgreementScheme::update(bool aware,
-                                                                               const std::vector<PeerInformation> &participating_nodes,
-                                                                               PeerInformation own_id,
-                                                                               std::vector<PeerInformation> &s_m,
-                                                                               round_t l) {
-  std::vector<PeerInformation> s_out;
+DistributedAgreementSchemeOutput DistributedAgreementScheme::update(bool aware,
+                                                                    size_t num_participating_nodes,
+                                                                    size_t own_position,
+                                                                    const ParticipantSet &s_m,
+                                                                    round_t l) {
+  DistributedAgreementSchemeOutput result;
+  if (num_participating_nodes > kMaxAgreementParticipants || own_position >= num_participating_nodes) {
+    return result; // no run can be started for such a gamma_agree (see ClientEnclave::update_overlay_handles)
+  }
   if (aware) { // init
-    set_s_i_.insert(own_id);
-    s_out.push_back(own_id);
+    set_s_i_.set(own_position);
+    result.aware_nodes.set(own_position);
   }
-  if (set_s_i_.empty()) {
-    set_s_i_.insert(own_id);
-    std::copy(set_s_i_.begin(), set_s_i_.end(), std::back_inserter(s_out));
-  } else if (!s_m.empty()) {
-    set_s_i_.insert(std::begin(s_m), std::end(s_m));
+  if (set_s_i_.none()) {
+    set_s_i_.set(own_position);
+    result.aware_nodes |= set_s_i_;
+  } else if (s_m.any()) {
+    set_s_i_ |= s_m;
   }
 
-  std::vector<DistributedAgreementSchemePair> result;
-  for (auto &id : participating_nodes) {
-    for (auto &s : s_out) {
-      result.emplace_back(DistributedAgreementSchemePair{id, s});
+  if (result.aware_nodes.any()) {
+    for (size_t i = 0; i < num_participating_nodes; ++i) {
+      result.receivers.set(i);
     }
   }
 
   return result;
 }
 
-bool DistributedAgreementScheme::finalize(PeerInformation own_id,
-                                          std::vector<PeerInformation> &s_m,
+bool DistributedAgreementScheme::finalize(size_t own_position,
+                                          const ParticipantSet &s_m,
                                           size_t t) {
-  set_s_i_.insert(std::begin(s_m), std::end(s_m));
-  set_s_i_.insert(own_id);
-  return set_s_i_.size() >= t + 1;
+  if (own_position >= kMaxAgreementParticipants) {
+    return false;
+  }
+  set_s_i_ |= s_m;
+  set_s_i_.set(own_position);
+  return set_s_i_.count() >= t + 1;
+}
+
+size_t DistributedAgreementScheme::position_of(const std::vector<peer_handle_t> &participating_nodes,
+                                               peer_handle_t node) {
+  return std::find(participating_nodes.begin(), participating_nodes.end(), node) - participating_nodes.begin();
 }
 
-} // !namespace
\ No newline at end of file
+} // !namespace
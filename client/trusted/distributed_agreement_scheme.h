@@ -2,15 +2,25 @@
 #define NETWORK_SGX_EXAMPLE_DISTRIBUTEDAGREEMENTSCHEME_H
 
 #include <vector>
-#include <set>
+#include <bitset>
 #include "../../include/config.h"
 #include "../../include/shared_structs.h"
+#include "structures/peer_registry.h"
 
 namespace c1::client {
 
-struct DistributedAgreementSchemePair {
-  PeerInformation receiver;
-  PeerInformation aware_node;
+/** maximal number of nodes taking part in one run of the agreement scheme (i.e., maximal size of gamma_agree) */
+constexpr size_t kMaxAgreementParticipants{256};
+
+/** a set of participants of an agreement run, bit j represents the j-th node of the run's participating_nodes */
+typedef std::bitset<kMaxAgreementParticipants> ParticipantSet;
+
+/**
+ * The messages emitted by one call of DistributedAgreementScheme::update(): every receiver is sent every aware node.
+ */
+struct DistributedAgreementSchemeOutput {
+  ParticipantSet receivers;
+  ParticipantSet aware_nodes;
 };
 
 /**
@@ -19,7 +29,7 @@ struct DistributedAgreementSchemePair {
 class DistributedAgreementScheme {
  private:
   /** see paper */
-  std::set<PeerInformation> set_s_i_;
+  ParticipantSet set_s_i_;
 
  public:
   DistributedAgreementScheme();
@@ -27,23 +37,31 @@ class DistributedAgreementScheme {
   /**
    * see paper
    * @param aware
-   * @param participating_nodes
-   * @param own_id
+   * @param num_participating_nodes size of participating_nodes
+   * @param own_position position of the node itself within participating_nodes
    * @param s_m
    * @param l
    * @return
    */
-  std::vector<DistributedAgreementSchemePair> update(bool aware,
-                                                     const std::vector<PeerInformation> &participating_nodes,
-                                                     PeerInformation own_id,
-                                                     std::vector<PeerInformation> &s_m,
-                                                     round_t l);
+  DistributedAgreementSchemeOutput update(bool aware,
+                                          size_t num_participating_nodes,
+                                          size_t own_position,
+                                          const ParticipantSet &s_m,
+                                          round_t l);
 
   /** see paper */
-  bool finalize(PeerInformation own_id,
-                std::vector<PeerInformation> &s_m,
+  bool finalize(size_t own_position,
+                const ParticipantSet &s_m,
                 size_t t);
 
+  /**
+   * Determine the position of the node node within participating_nodes.
+   * @param participating_nodes
+   * @param node
+   * @return the position or participating_nodes.size() if the node does not participate
+   */
+  static size_t position_of(const std::vector<peer_handle_t> &participating_nodes, peer_handle_t node);
+
 };
 
 } // !namespace
@@ -24,6 +24,16 @@ inline uint64_t calculate_routing_time(int dim) {
   return 2 * dim + 2;
 }
 
+/**
+ * calculate the round in which the messages announced in round cur_round are delivered
+ * @param cur_round
+ * @param dim
+ * @return
+ */
+inline round_t calculate_delivery_round(round_t cur_round, int dim) {
+  return cur_round + calculate_agreement_time(dim) + calculate_routing_time(dim) + 3;
+}
+
 /**
  * returns the l such that t in [4lDelta,(l+1)4Delta)
  * @param t
@@ -0,0 +1,43 @@
+#ifndef NETWORK_SGX_EXAMPLE_M_CORRUPT_FILTER_H
+#define NETWORK_SGX_EXAMPLE_M_CORRUPT_FILTER_H
+
+#include <map>
+#include <vector>
+#include "round_arena.h"
+
+namespace c1::client {
+
+/**
+ * For a given vector v of elements of type T, return those elements that occur more than m_corrupt times in v
+ * @tparam T Type of the elements in the vector (compared with operator<)
+ * @param vec The input vector
+ * @param m_corrupt
+ * @param arena the result (and the counters) are allocated from it
+ * @return pointers to the desired elements within vec (each element only once)
+ */
+template<typename T>
+arena_vector<const T *> obtain_elements_that_exceed_m_corrupt(const std::vector<T> &vec,
+                                                              size_t m_corrupt,
+                                                              RoundArena &arena) {
+  auto less = [](const T *lhs, const T *rhs) { return *lhs < *rhs; }; // compare the elements, not the pointers
+  ArenaAllocator<const T *> arena_allocator(arena);
+  std::map<const T *, size_t, decltype(less), ArenaAllocator<std::pair<const T *const, size_t>>>
+      elems_u_counter(less, arena_allocator);
+  for (const auto &elem_t : vec) {
+    elems_u_counter[&elem_t]++;
+  }
+
+  arena_vector<const T *> result(arena_allocator);
+
+  for (const auto &elem_u : elems_u_counter) {
+    if (elem_u.second > m_corrupt) {
+      result.push_back(elem_u.first);
+    }
+  }
+
+  return result;
+}
+
+}
+
+#endif //NETWORK_SGX_EXAMPLE_M_CORRUPT_FILTER_H
@@ -19,6 +19,7 @@ void OverlayStructureScheme::init(uint64_t onid_assoc,
   onid_assoc_ = onid_assoc;
   onid_emul_ = onid_emul;
   onid_emul_prev_ = onid_emul;
+  onid_emul_new_ = onid_emul; // until a new quorum is drawn in (3)(c)
   gamma_agree_ = gamma_route.at(onid_emul);
   gamma_send_ = gamma_send;
   gamma_receive_ = gamma_receive;
@@ -26,10 +27,11 @@ void OverlayStructureScheme::init(uint64_t onid_assoc,
   overlay_dimension_ = overlay_dimension;
   reconfiguration_time_ = reconfiguration_time;
   own_id_ = own_id;
+  view_outdated_ = true;
 }
 
-OverlayReturnTuple OverlayStructureScheme::update(round_t round,
-                                                  const std::vector<OverlayStructureSchemeMessage> &set_s) {
+const OverlayReturnTuple &OverlayStructureScheme::update(round_t round,
+                                                         const std::vector<OverlayStructureSchemeMessage> &set_s) {
 
   // the following is the simple code used so far...
 //  auto gamma_route_result = gamma_route_;
@@ -40,7 +42,8 @@ OverlayReturnTuple OverlayStructureScheme::update(round_t round,
 //  return OverlayReturnTuple{onid_emul_, gamma_agree_, gamma_send_, gamma_route_result, gamma_receive_, s_prime};
 
   // (1)
-  std::map<PeerInformation, std::vector<OverlayStructureSchemeMessage>> s_prime;
+  auto &s_prime = view_.s_overlay_prime;
+  s_prime.clear();
 
   // (2)
   std::map<onid_t, std::vector<OverlayStructureSchemeMessage>> msg_out_q;
@@ -52,12 +55,12 @@ OverlayReturnTuple OverlayStructureScheme::update(round_t round,
 
     // (b)
     onid_emul_ = onid_emul_new_;
-    gamma_agree_.clear();
-    for (auto &i_prime : gamma_route_new_[onid_emul_]) {
-      gamma_agree_.push_back(i_prime);
-    }
+    gamma_agree_ = gamma_route_new_[onid_emul_].peers();
     gamma_send_ = std::move(gamma_send_new_);
-    gamma_route_ = std::move(gamma_route_new_);
+    gamma_route_.clear();
+    for (auto&[onid, ids] : gamma_route_new_) {
+      gamma_route_[onid] = ids.release();
+    }
 
     // (c)
     uint64_t random_number = 12345;
@@ -86,6 +89,8 @@ OverlayReturnTuple OverlayStructureScheme::update(round_t round,
     // (g)
     gamma_route_succ_.clear();
 
+    view_outdated_ = true;
+
     // (h)
     msg_out_q[onid_emul_new_].push_back(OverlayStructureSchemeMessage::createEmulateRequestMsg(onid_emul_new_,
                                                                                                own_id_));
@@ -93,11 +98,12 @@ OverlayReturnTuple OverlayStructureScheme::update(round_t round,
 
   // (4)
   if (round % (reconfiguration_time_ / 2) == 2) {
-    gamma_receive_ == std::move(gamma_receive_new_);
+    // gamma_receive_ is kept (as before the PeerSet was introduced), only the collected requests are dropped
     gamma_receive_new_.clear();
     for (auto &i_prime : gamma_route_[onid_emul_]) {
       gamma_route_prev_[onid_emul_].push_back(i_prime);
     }
+    view_outdated_ = true;
   }
 
   // (5)
@@ -106,6 +112,7 @@ OverlayReturnTuple OverlayStructureScheme::update(round_t round,
     for (auto &i_prime : gamma_route_[onid_emul_]) {
       gamma_agree_prev_[onid_emul_].push_back(i_prime);
     }
+    view_outdated_ = true;
   }
 
   // (6)
@@ -134,19 +141,9 @@ OverlayReturnTuple OverlayStructureScheme::update(round_t round,
     // (c)
     if (s.t == OverlayStructureSchemeMessage::OverlayStructureSchemeMessageType::tHandOverMsg) {
       for (auto&[onid, ids] : s.gamma_route) {
-        for (auto &elem : ids) {
-          if (std::find(gamma_route_new_[onid].begin(), gamma_route_new_[onid].end(), elem)
-              == gamma_route_new_[onid].end()) { // do not add elements twice
-            gamma_route_new_[onid].push_back(elem);
-          }
-        }
-      }
-      for (auto &elem : s.gamma_receive) {
-        if (std::find(gamma_receive_new_.begin(), gamma_receive_new_.end(), elem)
-            == gamma_receive_new_.end()) { // do not add elements twice
-          gamma_receive_new_.push_back(elem);
-        }
+        gamma_route_new_[onid].insert(ids); // elements are not added twice
       }
+      gamma_receive_new_.insert(s.gamma_receive);
     }
 
     // (d)
@@ -190,26 +187,37 @@ OverlayReturnTuple OverlayStructureScheme::update(round_t round,
     }
   }
 
-  // (10)
-  auto gamma_route_result = gamma_route_;
+  // (10) - only if the overlay has changed (i.e., in the rounds of a reconfiguration)
+  if (view_outdated_) {
+    rebuild_view();
+  }
+
+  return view_;
+}
+
+void OverlayStructureScheme::rebuild_view() {
+  std::map<onid_t, PeerSet> merged;
+  for (const auto&[onid, ids] : gamma_route_) {
+    merged[onid].insert(ids);
+  }
   for (const auto&[onid, ids] : gamma_agree_prev_) {
-    for (auto &id: ids) {
-      if (std::find(gamma_route_result[onid].begin(), gamma_route_result[onid].end(), id)
-          == gamma_route_result[onid].end()) { // I know this is inefficient ...
-        gamma_route_result[onid].push_back(id);
-      }
-    }
+    merged[onid].insert(ids);
   }
   for (const auto&[onid, ids] : gamma_route_prev_) {
-    for (auto &id: ids) {
-      if (std::find(gamma_route_result[onid].begin(), gamma_route_result[onid].end(), id)
-          == gamma_route_result[onid].end()) { // I know this is inefficient ...
-        gamma_route_result[onid].push_back(id);
-      }
-    }
+    merged[onid].insert(ids);
+  }
+  std::map<onid_t, std::vector<PeerInformation>> gamma_route_result;
+  for (auto&[onid, ids] : merged) {
+    gamma_route_result.emplace_hint(gamma_route_result.end(), onid, ids.release());
   }
 
-  return OverlayReturnTuple{onid_emul_, gamma_agree_, gamma_send_, gamma_route_result, gamma_receive_, s_prime};
+  view_.version++;
+  view_.onid_emul = onid_emul_;
+  view_.gamma_agree = std::make_shared<const std::vector<PeerInformation>>(gamma_agree_);
+  view_.gamma_send = gamma_send_;
+  view_.gamma_route = std::move(gamma_route_result);
+  view_.gamma_receive = gamma_receive_;
+  view_outdated_ = false;
 }
 
 void OverlayStructureSchemeMessage::serialize(std::vector<uint8_t> &working_vec) const {
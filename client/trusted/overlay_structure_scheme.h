@@ -7,6 +7,7 @@
 
 #include <cstdint>
 #include "structures.h"
+#include "structures/peer_set.h"
 #include "../../include/shared_structs.h"
 
 namespace c1::client {
@@ -72,9 +73,14 @@ class OverlayStructureSchemeMessage : public Serializable {
 
 };
 
+/**
+ * The view of the overlay returned by OverlayStructureScheme::update().
+ * It is kept by the scheme and only rebuilt when the overlay changes; version is incremented on every such change.
+ */
 struct OverlayReturnTuple {
+  uint64_t version = 0;
   onid_t onid_emul;
-  std::vector<PeerInformation> gamma_agree;
+  std::shared_ptr<const std::vector<PeerInformation>> gamma_agree;
   std::vector<PeerInformation> gamma_send;
   std::map<onid_t, std::vector<PeerInformation>> gamma_route;
   std::vector<PeerInformation> gamma_receive;
@@ -97,12 +103,20 @@ class OverlayStructureScheme {
   onid_t onid_emul_new_;
   std::map<uint64_t, std::vector<PeerInformation>> gamma_agree_prev_;
   std::vector<PeerInformation> gamma_send_new_;
-  std::map<uint64_t, std::vector<PeerInformation>> gamma_route_new_;
+  std::map<uint64_t, PeerSet> gamma_route_new_;
   std::map<uint64_t, std::vector<PeerInformation>> gamma_route_succ_;
   std::map<uint64_t, std::vector<PeerInformation>> gamma_route_prev_;
-  std::vector<PeerInformation> gamma_receive_new_;
+  PeerSet gamma_receive_new_;
   std::map<uint64_t, std::vector<PeerInformation>> new_neighbors_for_q_e_;
 
+  /** the view returned by update() */
+  OverlayReturnTuple view_;
+  /** whether the overlay has changed since view_ was built */
+  bool view_outdated_ = true;
+
+  /** rebuild view_ (including the merge of gamma_route_, gamma_agree_prev_ and gamma_route_prev_) */
+  void rebuild_view();
+
  public:
   void init(uint64_t onid_assoc,
             uint64_t onid_emul,
@@ -113,7 +127,13 @@ class OverlayStructureScheme {
             uint64_t reconfiguration_time,
             PeerInformation own_id);
 
-  OverlayReturnTuple update(round_t round, const std::vector<OverlayStructureSchemeMessage> &set_s);
+  /**
+   * see paper
+   * @param round
+   * @param set_s
+   * @return the current view of the overlay (valid until the next call of update)
+   */
+  const OverlayReturnTuple &update(round_t round, const std::vector<OverlayStructureSchemeMessage> &set_s);
 
 };
 
@@ -0,0 +1,135 @@
+#ifndef NETWORK_SGX_EXAMPLE_ROUND_ARENA_H
+#define NETWORK_SGX_EXAMPLE_ROUND_ARENA_H
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <algorithm>
+#include <vector>
+
+namespace c1::client {
+
+/**
+ * Counters of a RoundArena.
+ */
+struct RoundArenaStats {
+  /** number of allocations served in the current round */
+  size_t allocations = 0;
+  /** bytes handed out in the current round */
+  size_t bytes = 0;
+  /** maximal number of bytes handed out in any round (the current one is accounted at the next reset) */
+  size_t peak_bytes = 0;
+  /** number of blocks obtained from the heap since the arena has been created */
+  size_t heap_blocks = 0;
+};
+
+/**
+ * A bump allocator for data that lives for (at most) one round. Memory is never freed individually, reset() makes all
+ * of it available again at once. Whenever a round needed more than one block, the blocks are replaced by a single one
+ * of the combined size, so that the following rounds do not need the heap at all.
+ */
+class RoundArena {
+  struct Block {
+    std::unique_ptr<uint8_t[]> data;
+    size_t size;
+  };
+  std::vector<Block> blocks_;
+  size_t cur_block_ = 0;
+  size_t offset_ = 0;
+  RoundArenaStats stats_;
+
+  void add_block(size_t size) {
+    blocks_.push_back(Block{std::unique_ptr<uint8_t[]>(new uint8_t[size]), size});
+    stats_.heap_blocks++;
+  }
+
+ public:
+  explicit RoundArena(size_t initial_size = 64 * 1024) {
+    add_block(initial_size);
+  }
+
+  RoundArena(const RoundArena &) = delete;
+  RoundArena &operator=(const RoundArena &) = delete;
+
+  void *allocate(size_t bytes, size_t alignment) {
+    stats_.allocations++;
+    stats_.bytes += bytes;
+    while (true) {
+      auto &block = blocks_[cur_block_];
+      auto address = reinterpret_cast<uintptr_t>(block.data.get()) + offset_;
+      auto padding = (alignment - address % alignment) % alignment;
+      if (offset_ + padding + bytes <= block.size) {
+        offset_ += padding + bytes;
+        return reinterpret_cast<void *>(address + padding);
+      }
+      if (cur_block_ + 1 == blocks_.size()) {
+        add_block(std::max(block.size * 2, bytes + alignment));
+      }
+      cur_block_++;
+      offset_ = 0;
+    }
+  }
+
+  /**
+   * Make all memory available again. Everything allocated before must not be used anymore.
+   */
+  void reset() {
+    stats_.peak_bytes = std::max(stats_.peak_bytes, stats_.bytes);
+    if (blocks_.size() > 1) {
+      size_t total_size = 0;
+      for (const auto &block : blocks_) {
+        total_size += block.size;
+      }
+      blocks_.clear();
+      add_block(total_size);
+    }
+    cur_block_ = 0;
+    offset_ = 0;
+    stats_.allocations = 0;
+    stats_.bytes = 0;
+  }
+
+  const RoundArenaStats &stats() const {
+    return stats_;
+  }
+};
+
+/**
+ * Allocator handing out memory of a RoundArena (deallocate() does nothing), to be used with the std containers.
+ */
+template<typename T>
+class ArenaAllocator {
+  template<typename U> friend
+  class ArenaAllocator;
+
+  RoundArena *arena_;
+
+ public:
+  typedef T value_type;
+
+  explicit ArenaAllocator(RoundArena &arena) : arena_(&arena) {}
+  template<typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) : arena_(other.arena_) {}
+
+  T *allocate(size_t n) {
+    return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T *, size_t) {}
+
+  template<typename U>
+  bool operator==(const ArenaAllocator<U> &rhs) const {
+    return arena_ == rhs.arena_;
+  }
+  template<typename U>
+  bool operator!=(const ArenaAllocator<U> &rhs) const {
+    return arena_ != rhs.arena_;
+  }
+};
+
+/** a vector whose memory is taken from a RoundArena */
+template<typename T>
+using arena_vector = std::vector<T, ArenaAllocator<T>>;
+
+}
+
+#endif //NETWORK_SGX_EXAMPLE_ROUND_ARENA_H
@@ -7,12 +7,13 @@
 
 namespace c1::client {
 
-std::vector<RoutingSchemeTuple> RoutingScheme::route(std::vector<RoutingSchemeTuple> &set_s,
+arena_vector<RoutingSchemeTuple> RoutingScheme::route(arena_vector<RoutingSchemeTuple> &set_s,
                                                      round_t cur_round,
                                                      size_t overlay_dimension,
                                                      const sgx_cmac_128bit_key_t &sk_routing) {
   auto cancel_set = determine_elements_to_be_cancelled(set_s);
-  std::vector<RoutingSchemeTuple> result;
+  arena_vector<RoutingSchemeTuple> result(set_s.get_allocator());
+  result.reserve(set_s.size());
 
   for (auto &s : set_s) {
     if (cancel_set.count(RoutingSchemeTuple{MessageTuple::create_cancel(), s.onid_dst,
@@ -38,8 +39,10 @@ std::vector<RoutingSchemeTuple> RoutingScheme::route(std::vector<RoutingSchemeTu
   return result;
 }
 
-std::set<RoutingSchemeTuple> RoutingScheme::determine_elements_to_be_cancelled(std::vector<RoutingSchemeTuple> &set_s) {
-  std::set<RoutingSchemeTuple> result;
+std::set<RoutingSchemeTuple, std::less<RoutingSchemeTuple>, ArenaAllocator<RoutingSchemeTuple>>
+RoutingScheme::determine_elements_to_be_cancelled(arena_vector<RoutingSchemeTuple> &set_s) {
+  std::set<RoutingSchemeTuple, std::less<RoutingSchemeTuple>, ArenaAllocator<RoutingSchemeTuple>>
+      result(set_s.get_allocator());
 
   if (set_s.size() == 0) {
     return result;
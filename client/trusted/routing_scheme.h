@@ -2,7 +2,9 @@
 #define NETWORK_SGX_EXAMPLE_ROUTING_SCHEME_H
 
 #include <sgx_tcrypto.h>
+#include <set>
 #include "structures.h"
+#include "round_arena.h"
 
 namespace c1::client {
 
@@ -17,9 +19,9 @@ class RoutingScheme {
    * @param cur_round
    * @param overlay_dimension
    * @param sk_routing
-   * @return
+   * @return (allocated from the same arena as set_s)
    */
-  static std::vector<RoutingSchemeTuple> route(std::vector<RoutingSchemeTuple> &set_s,
+  static arena_vector<RoutingSchemeTuple> route(arena_vector<RoutingSchemeTuple> &set_s,
                                                round_t cur_round,
                                                size_t overlay_dimension,
                                                const sgx_cmac_128bit_key_t &sk_routing
@@ -29,7 +31,8 @@ class RoutingScheme {
   /** determine all messages that have to be cancelled in the current call of route()
    *  (messages that exceed k_receive for one target bucket are dropped and replaced by M_cancel, see paper)
    */
-  static std::set<RoutingSchemeTuple> determine_elements_to_be_cancelled(std::vector<RoutingSchemeTuple> &set_s);
+  static std::set<RoutingSchemeTuple, std::less<RoutingSchemeTuple>, ArenaAllocator<RoutingSchemeTuple>>
+  determine_elements_to_be_cancelled(arena_vector<RoutingSchemeTuple> &set_s);
 };
 
 } // !namespace
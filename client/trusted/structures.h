@@ -8,6 +8,8 @@
 #include <cstdint>
 #include <array>
 #include <vector>
+#include <memory>
+#include <algorithm>
 #include <ostream>
 #include "../../include/serialization.h"
 #include "../../include/config.h"
@@ -75,6 +77,7 @@ class Pseudonym : public Serializable {
   static Pseudonym deserialize(const std::vector<uint8_t> &working_vec, size_t &cur) {
     Pseudonym result;
     std::copy(&working_vec[cur], &working_vec[cur] + result.pseud_.size(), result.pseud_.begin());
+    cur += result.pseud_.size();
     return result;
   }
 
@@ -187,6 +190,7 @@ class Message : public Serializable {
   static Message deserialize(const std::vector<uint8_t> &working_vec, size_t &cur) {
     Message result;
     std::copy(&working_vec[cur], &working_vec[cur] + result.msg_.size(), result.msg_.begin());
+    cur += result.msg_.size();
     return result;
   }
 
@@ -248,6 +252,41 @@ class MessageTuple : public Serializable {
     return t_dst == 1; // see above
   }
 
+  /** size of a serialized MessageTuple */
+  static constexpr size_t kSerializedSize = kPseudonymSize + kMessageSize + kPseudonymSize + sizeof(round_t);
+
+  /**
+   * Checks whether the serialized tuple at cur is a dummy without deserializing it.
+   * @param working_vec
+   * @param cur index of the first byte of the serialized tuple, advanced past the tuple if it is a dummy
+   * @return whether the tuple is a dummy (and has thus been skipped)
+   */
+  static bool skip_dummy(const std::vector<uint8_t> &working_vec, size_t &cur) {
+    auto t_dst_begin = working_vec.begin() + cur + kSerializedSize - sizeof(round_t);
+    if (!std::all_of(t_dst_begin, t_dst_begin + sizeof(round_t), [](uint8_t byte) { return byte == 0; })) {
+      return false;
+    }
+    cur += kSerializedSize;
+    return true;
+  }
+
+  /**
+   * 64 bit FNV-1a digest over all fields (not cryptographically secure, only used to index message tuples)
+   * @return
+   */
+  uint64_t digest() const {
+    uint64_t result = 14695981039346656037UL;
+    auto absorb = [&result](uint8_t byte) {
+      result ^= byte;
+      result *= 1099511628211UL;
+    };
+    for (auto byte : n_src.get()) absorb(byte);
+    for (auto byte : m.get()) absorb(byte);
+    for (auto byte : n_dst.get()) absorb(byte);
+    for (size_t i = 0; i < sizeof(t_dst); ++i) absorb((t_dst >> 8 * i) & 0xFF);
+    return result;
+  }
+
   void serialize(std::vector<uint8_t> &working_vec) const override {
     n_src.serialize(working_vec);
     m.serialize(working_vec);
@@ -274,46 +313,81 @@ class MessageTuple : public Serializable {
 };
 
 /**
- * A structure used for the agreement scheme internally.
+ * Hash function for MessageTuple, so that tuples can be indexed by message (see MessageTuple::digest()).
+ */
+struct MessageTupleHash {
+  size_t operator()(const MessageTuple &message) const {
+    return message.digest();
+  }
+};
+
+/**
+ * A structure used for the agreement scheme internally (the message itself is the key it is stored under).
  */
 struct AgreementLocalTuple {
   //AgreementLocalTuple() {}
-  MessageTuple message;
   /** true means INIT, false means unaware */
   bool aware;
   DistributedAgreementScheme agreement_scheme;
-  std::vector<PeerInformation> participating_nodes;
+  /** gamma_agree of the round the run was started in (shared between all runs of that round) */
+  std::shared_ptr<const std::vector<peer_handle_t>> participating_nodes;
+  /** position of the node itself within participating_nodes */
+  size_t own_position;
   round_t round;
 };
 
 /**
  * A structure used for the agreement scheme (sent between enclaves).
+ * Carries the message once, together with the ids of all aware nodes the sender announces to the receiver.
  */
 class AgreementTuple : public Serializable {
  public:
   MessageTuple m;
-  PeerInformation s;
+  std::vector<uint64_t> s;
   round_t l;
 
   AgreementTuple(const MessageTuple &m,
-                 const PeerInformation &s,
+                 const std::vector<uint64_t> &s,
                  round_t l) : m(m), s(s), l(l) {}
 
+  bool operator==(const AgreementTuple &rhs) const {
+    return std::tie(m, s, l) == std::tie(rhs.m, rhs.s, rhs.l);
+  }
+  bool operator!=(const AgreementTuple &rhs) const {
+    return !(rhs == *this);
+  }
+
   void serialize(std::vector<uint8_t> &working_vec) const override {
     m.serialize(working_vec);
-    s.serialize(working_vec);
+    serialize_number(working_vec, s.size());
+    for (auto id : s) {
+      serialize_number(working_vec, id);
+    }
     serialize_number(working_vec, l);
   }
 
   static AgreementTuple deserialize(const std::vector<uint8_t> &working_vec, size_t &cur) {
     auto m = MessageTuple::deserialize(working_vec, cur);
-    auto s = PeerInformation::deserialize(working_vec, cur);
+    auto count = deserialize_number<size_t>(working_vec, cur);
+    std::vector<uint64_t> s;
+    s.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      s.push_back(deserialize_number<uint64_t>(working_vec, cur));
+    }
     auto l = deserialize_number<round_t>(working_vec, cur);
     return AgreementTuple{m, s, l};
   };
 
 };
 
+/**
+ * The agreement messages received for one message, i.e., s_m (as ids) and the round l of the agreement run.
+ */
+struct AgreementInboxEntry {
+  round_t l;
+  std::vector<uint64_t> s_m;
+};
+
 /**
  * A structure used for the routing scheme (sent between enclaves).
  */
@@ -366,6 +440,25 @@ struct RoutingSchemeTuple : public Serializable {
   static RoutingSchemeTuple create_dummy() {
     return RoutingSchemeTuple{MessageTuple::create_dummy(), 0, Pseudonym::create_dummy(), 0, 0};
   }
+
+  /** size of a serialized RoutingSchemeTuple */
+  static constexpr size_t kSerializedSize =
+      MessageTuple::kSerializedSize + sizeof(onid_t) + kPseudonymSize + sizeof(round_t) + sizeof(onid_t);
+
+  /**
+   * Checks whether the serialized tuple at cur is a dummy (i.e., carries a dummy message) without deserializing it.
+   * @param working_vec
+   * @param cur index of the first byte of the serialized tuple, advanced past the tuple if it is a dummy
+   * @return whether the tuple is a dummy (and has thus been skipped)
+   */
+  static bool skip_dummy(const std::vector<uint8_t> &working_vec, size_t &cur) {
+    size_t message_cur = cur;
+    if (!MessageTuple::skip_dummy(working_vec, message_cur)) {
+      return false;
+    }
+    cur += kSerializedSize;
+    return true;
+  }
 };
 
 /**
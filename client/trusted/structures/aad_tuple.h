@@ -22,6 +22,9 @@ struct AadTuple : Serializable {
   round_t round;
   std::vector<OverlayStructureSchemeMessage> p_structure;
 
+  /** size of the serialized sender, receiver and round (see deserialize_header) */
+  static constexpr size_t kHeaderSize = 2 * PeerInformation::kSerializedSize + sizeof(round_t);
+
   AadTuple(PeerInformation sender,
            PeerInformation receiver,
            round_t round,
@@ -36,6 +39,19 @@ struct AadTuple : Serializable {
     serialize_vec(working_vec, p_structure);
   }
 
+  /**
+   * Deserializes only sender, receiver and round, i.e., the part of the aad that precedes p_structure.
+   */
+  static void deserialize_header(const std::vector<uint8_t> &working_vec,
+                                 size_t &cur,
+                                 PeerInformation &sender,
+                                 PeerInformation &receiver,
+                                 round_t &round) {
+    sender = PeerInformation::deserialize(working_vec, cur);
+    receiver = PeerInformation::deserialize(working_vec, cur);
+    round = deserialize_number<round_t>(working_vec, cur);
+  }
+
   static AadTuple deserialize(const std::vector<uint8_t> &working_vec, size_t &cur) {
     auto sender = PeerInformation::deserialize(working_vec, cur);
     auto receiver = PeerInformation::deserialize(working_vec, cur);
@@ -0,0 +1,94 @@
+#ifndef NETWORK_SGX_EXAMPLE_AGREEMENT_RUNS_H
+#define NETWORK_SGX_EXAMPLE_AGREEMENT_RUNS_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "../structures.h"
+#include "../distributed_agreement_scheme.h"
+
+namespace c1::client {
+
+/**
+ * The running agreement scheme runs of a node (agreement_tuples of the paper).
+ * Every announce starts a run of its own, even if a run for an equal message (e.g. another dummy) is running already,
+ * so that the number of agreement messages a node sends does not depend on how many of its announces are real.
+ */
+class AgreementRuns {
+  std::unordered_multimap<MessageTuple, AgreementLocalTuple, MessageTupleHash> runs_;
+
+ public:
+  /**
+   * Starts a run for message.
+   * @param participating_nodes gamma_agree of the run
+   * @return false if own_handle is no participant (no run is started then)
+   */
+  bool start(const MessageTuple &message,
+             bool aware,
+             const std::shared_ptr<const std::vector<peer_handle_t>> &participating_nodes,
+             peer_handle_t own_handle,
+             round_t round) {
+    auto own_position = DistributedAgreementScheme::position_of(*participating_nodes, own_handle);
+    if (own_position == participating_nodes->size()) {
+      return false;
+    }
+    runs_.emplace(message, AgreementLocalTuple{aware, DistributedAgreementScheme(), participating_nodes,
+                                               own_position, round});
+    return true;
+  }
+
+  /** @return whether at least one run for message is running */
+  bool contains(const MessageTuple &message) const {
+    return runs_.count(message) != 0;
+  }
+
+  /**
+   * Calls update on every run and advances it by one round.
+   * @param s_m_of (message, run) -> ParticipantSet, the aware nodes received for the run
+   * @param emit (message, run, output), called for every run whose update emits agreement messages
+   */
+  template<typename SmOf, typename Emit>
+  void update(SmOf &&s_m_of, Emit &&emit) {
+    for (auto &[message, run] : runs_) {
+      auto output = run.agreement_scheme.update(run.aware,
+                                                run.participating_nodes->size(),
+                                                run.own_position,
+                                                s_m_of(message, run),
+                                                run.round + 1);
+      run.round++;
+      run.aware = false;
+      if (output.aware_nodes.any()) {
+        emit(message, run, output);
+      }
+    }
+  }
+
+  /**
+   * Removes the runs that were finalized in the previous round and finalizes the runs that end in this one.
+   * @param agreement_time L_agreement
+   * @param s_m_of see update()
+   * @param on_finalized (message, v), called with the result v of every finalized run
+   */
+  template<typename SmOf, typename OnFinalized>
+  void finalize(round_t agreement_time, SmOf &&s_m_of, OnFinalized &&on_finalized) {
+    for (auto it = runs_.begin(); it != runs_.end();) {
+      auto &[message, run] = *it;
+      if (run.round == agreement_time) {
+        it = runs_.erase(it);
+        continue;
+      }
+      if (run.round == agreement_time - 1) {
+        on_finalized(message, run.agreement_scheme.finalize(run.own_position, s_m_of(message, run), 0));
+      }
+      ++it;
+    }
+  }
+
+  size_t size() const {
+    return runs_.size();
+  }
+};
+
+} // !namespace
+
+#endif //NETWORK_SGX_EXAMPLE_AGREEMENT_RUNS_H
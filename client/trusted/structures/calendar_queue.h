@@ -0,0 +1,99 @@
+#ifndef NETWORK_SGX_EXAMPLE_CALENDAR_QUEUE_H
+#define NETWORK_SGX_EXAMPLE_CALENDAR_QUEUE_H
+
+#include <vector>
+#include <map>
+#include "../../../include/config.h"
+
+namespace c1::client {
+
+/**
+ * A queue of elements that become due in a certain round and are always taken out a whole round at once.
+ * The next kNumBuckets rounds are stored in a ring of bucket vectors (indexed by round modulo kNumBuckets), rounds
+ * further in the future in an overflow map that is moved into the ring as the rounds advance. Pushing is O(1) for all
+ * rounds within the ring, taking out a round is a swap of its bucket.
+ */
+template<typename T>
+class CalendarQueue {
+ public:
+  static constexpr size_t kNumBuckets = 64;
+
+ private:
+  std::vector<std::vector<T>> buckets_ = std::vector<std::vector<T>>(kNumBuckets);
+  /** the earliest round that has not been taken out yet (buckets_ covers [first_round_, first_round_ + kNumBuckets)) */
+  round_t first_round_ = 0;
+  std::map<round_t, std::vector<T>> overflow_;
+  size_t size_ = 0;
+
+  std::vector<T> &bucket(round_t round) {
+    return buckets_[round % kNumBuckets];
+  }
+
+ public:
+  /**
+   * Adds elem to the elements of round.
+   * @return false if round has already been taken out (elem is discarded then)
+   */
+  bool push(round_t round, T elem) {
+    if (round < first_round_) {
+      return false;
+    }
+    if (round < first_round_ + kNumBuckets) {
+      bucket(round).push_back(std::move(elem));
+    } else {
+      overflow_[round].push_back(std::move(elem));
+    }
+    size_++;
+    return true;
+  }
+
+  /**
+   * Takes out all elements of round. The elements of earlier rounds that have not been taken out are discarded.
+   * @param round
+   * @param out replaced by the elements of round (in order of insertion), its memory is reused by the queue
+   * @return the number of elements discarded
+   */
+  size_t pop_round(round_t round, std::vector<T> &out) {
+    out.clear();
+    if (round < first_round_) {
+      return 0;
+    }
+    size_t discarded = 0;
+    for (auto r = first_round_; r < round && r < first_round_ + kNumBuckets; r++) {
+      discarded += bucket(r).size();
+      bucket(r).clear();
+    }
+    if (round < first_round_ + kNumBuckets) {
+      std::swap(out, bucket(round));
+    } else { // round was (if at all) in the overflow map, which may still contain earlier rounds
+      for (auto it = overflow_.begin(); it != overflow_.end() && it->first <= round; it = overflow_.erase(it)) {
+        if (it->first == round) {
+          std::swap(out, it->second);
+        } else {
+          discarded += it->second.size();
+        }
+      }
+    }
+    first_round_ = round + 1;
+
+    // move the rounds that are covered by the ring now
+    for (auto it = overflow_.begin(); it != overflow_.end() && it->first < first_round_ + kNumBuckets;
+         it = overflow_.erase(it)) {
+      std::swap(bucket(it->first), it->second);
+    }
+    size_ -= discarded + out.size();
+    return discarded;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+};
+
+}
+
+#endif //NETWORK_SGX_EXAMPLE_CALENDAR_QUEUE_H
@@ -0,0 +1,107 @@
+#ifndef NETWORK_SGX_EXAMPLE_INBOX_H
+#define NETWORK_SGX_EXAMPLE_INBOX_H
+
+#include <array>
+#include <algorithm>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "../structures.h"
+#include "../overlay_structure_scheme.h"
+#include "peer_registry.h"
+
+namespace c1::client {
+
+/**
+ * The sets in (see paper) received for one round, together with the senders they have been received from.
+ */
+struct InboxSlot {
+  std::vector<OverlayStructureSchemeMessage> structure;
+  std::vector<MessageTuple> announce;
+  std::unordered_map<MessageTuple, AgreementInboxEntry, MessageTupleHash> agreement;
+  std::vector<MessageTuple> inject;
+  std::vector<std::vector<RoutingSchemeTuple>> routing;
+  std::vector<MessageTuple> predeliver;
+  std::unordered_set<MessageTuple, MessageTupleHash> deliver;
+  /** used to ignore messages sent twice (to prevent replay attacks) */
+  std::unordered_set<peer_handle_t> received_from;
+};
+
+/**
+ * The sets in for the current and the next round (we may receive messages for the next round due to delay), stored
+ * in a ring of slots that keep their capacity: advancing to the next round only clears a slot and rotates the index.
+ */
+class Inbox {
+ public:
+  /** number of rounds messages can be received for */
+  static constexpr size_t kNumRounds = 2;
+
+ private:
+  std::array<InboxSlot, kNumRounds> slots_;
+  size_t cur_ = 0;
+  /** the maximal sizes the sets of a slot have reached so far, used to reserve the storage of fresh slots */
+  struct {
+    size_t structure = 0;
+    size_t announce = 0;
+    size_t agreement = 0;
+    size_t inject = 0;
+    size_t routing = 0;
+    size_t predeliver = 0;
+    size_t deliver = 0;
+    size_t received_from = 0;
+  } high_water_mark_;
+
+ public:
+  /**
+   * @param offset 0 for the current round, 1 for the next round, ...
+   * @return the slot for the round cur_round + offset
+   */
+  InboxSlot &for_round(size_t offset) {
+    return slots_[(cur_ + offset) % kNumRounds];
+  }
+
+  /** the slot of the current round */
+  InboxSlot &current() {
+    return slots_[cur_];
+  }
+
+  /**
+   * Clear the slot of the current round and make the next round the current one.
+   */
+  void advance() {
+    auto &slot = slots_[cur_];
+    high_water_mark_.structure = std::max(high_water_mark_.structure, slot.structure.size());
+    high_water_mark_.announce = std::max(high_water_mark_.announce, slot.announce.size());
+    high_water_mark_.agreement = std::max(high_water_mark_.agreement, slot.agreement.size());
+    high_water_mark_.inject = std::max(high_water_mark_.inject, slot.inject.size());
+    high_water_mark_.routing = std::max(high_water_mark_.routing, slot.routing.size());
+    high_water_mark_.predeliver = std::max(high_water_mark_.predeliver, slot.predeliver.size());
+    high_water_mark_.deliver = std::max(high_water_mark_.deliver, slot.deliver.size());
+    high_water_mark_.received_from = std::max(high_water_mark_.received_from, slot.received_from.size());
+
+    slot.structure.clear();
+    slot.announce.clear();
+    slot.agreement.clear();
+    slot.inject.clear();
+    slot.routing.clear();
+    slot.predeliver.clear();
+    slot.deliver.clear();
+    slot.received_from.clear();
+
+    // the cleared slot receives the messages of the last round of the ring
+    slot.structure.reserve(high_water_mark_.structure);
+    slot.announce.reserve(high_water_mark_.announce);
+    slot.agreement.reserve(high_water_mark_.agreement);
+    slot.inject.reserve(high_water_mark_.inject);
+    slot.routing.reserve(high_water_mark_.routing);
+    slot.predeliver.reserve(high_water_mark_.predeliver);
+    slot.deliver.reserve(high_water_mark_.deliver);
+    slot.received_from.reserve(high_water_mark_.received_from);
+
+    cur_ = (cur_ + 1) % kNumRounds;
+  }
+};
+
+}
+
+#endif //NETWORK_SGX_EXAMPLE_INBOX_H
@@ -0,0 +1,98 @@
+#ifndef NETWORK_SGX_EXAMPLE_OUTBOX_H
+#define NETWORK_SGX_EXAMPLE_OUTBOX_H
+
+#include <vector>
+#include <map>
+#include "../structures.h"
+#include "../overlay_structure_scheme.h"
+#include "peer_registry.h"
+
+namespace c1::client {
+
+/**
+ * Everything traffic_out sends to one peer in one round (the sets out_* of the paper, restricted to that peer).
+ */
+struct OutboxRecord {
+  std::vector<MessageTuple> announce;
+  std::vector<AgreementTuple> agreement;
+  std::vector<MessageTuple> inject;
+  /** the serialized routing and predeliver sets (shared by all peers of a quorum), nullptr if none */
+  const std::vector<uint8_t> *shared_segment = nullptr;
+  std::vector<MessageTuple> deliver;
+  std::vector<OverlayStructureSchemeMessage> structure;
+  /** whether this peer receives a message in the current round */
+  bool used = false;
+};
+
+/**
+ * The out sets of traffic_out: one record per peer (indexed by peer handle) plus the per-quorum parts.
+ * It lives as long as the enclave and is reset instead of freed between rounds, so that the capacity of its vectors
+ * is reused.
+ */
+class Outbox {
+  std::vector<OutboxRecord> records_;
+  /** handles of the records used in the current round, in order of first use */
+  std::vector<peer_handle_t> receivers_;
+
+ public:
+  /** out_routing, identical for all nodes of a quorum */
+  std::map<onid_t, std::vector<RoutingSchemeTuple>> routing;
+  /** out_predeliver, identical for all nodes of gamma_route[onid_emul_l_prev] */
+  std::vector<MessageTuple> predeliver;
+  /** the serialized routing and predeliver sets of every quorum */
+  std::map<onid_t, std::vector<uint8_t>> shared_segment_for_quorum;
+
+  /**
+   * The record of peer i, which will receive a message in the current round from now on.
+   * @param i
+   * @return
+   */
+  OutboxRecord &for_peer(peer_handle_t i) {
+    if (i >= records_.size()) {
+      records_.resize(i + 1);
+    }
+    auto &record = records_[i];
+    if (!record.used) {
+      record.used = true;
+      receivers_.push_back(i);
+    }
+    return record;
+  }
+
+  const OutboxRecord &at(peer_handle_t i) const {
+    return records_.at(i);
+  }
+
+  /** the peers receiving a message in the current round */
+  const std::vector<peer_handle_t> &receivers() const {
+    return receivers_;
+  }
+
+  /**
+   * Empty all sets for the next round (keeping their capacity).
+   */
+  void reset() {
+    for (auto i : receivers_) {
+      auto &record = records_[i];
+      record.announce.clear();
+      record.agreement.clear();
+      record.inject.clear();
+      record.shared_segment = nullptr;
+      record.deliver.clear();
+      record.structure.clear();
+      record.used = false;
+    }
+    receivers_.clear();
+    for (auto &[onid, tuples] : routing) {
+      tuples.clear();
+    }
+    predeliver.clear();
+    for (auto &[onid, shared_segment] : shared_segment_for_quorum) {
+      shared_segment.clear();
+    }
+  }
+};
+
+}
+
+#endif //NETWORK_SGX_EXAMPLE_OUTBOX_H
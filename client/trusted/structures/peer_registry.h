@@ -0,0 +1,70 @@
+#ifndef NETWORK_SGX_EXAMPLE_PEER_REGISTRY_H
+#define NETWORK_SGX_EXAMPLE_PEER_REGISTRY_H
+
+#include <vector>
+#include <unordered_map>
+#include "../../../include/shared_structs.h"
+
+namespace c1::client {
+
+/** dense, enclave-local handle of a peer (see PeerRegistry), never sent over the network */
+typedef uint32_t peer_handle_t;
+
+/**
+ * Interns every peer the enclave deals with once and hands out dense handles (0, 1, 2, ...), so that per-peer data
+ * can be stored in plain arrays. The PeerInformation itself is only needed at the network boundary.
+ */
+class PeerRegistry {
+  std::vector<PeerInformation> peers_;
+  std::unordered_map<uint64_t, peer_handle_t> handle_for_id_;
+
+ public:
+  /** returned by find() for unknown peers */
+  static constexpr peer_handle_t kNoPeer = static_cast<peer_handle_t>(-1);
+
+  /**
+   * Returns the handle of peer (peers are identified by their id), registering it if necessary.
+   * @param peer
+   * @return
+   */
+  peer_handle_t intern(const PeerInformation &peer) {
+    auto[it, inserted] = handle_for_id_.try_emplace(peer.id, static_cast<peer_handle_t>(peers_.size()));
+    if (inserted) {
+      peers_.push_back(peer);
+    } else {
+      peers_[it->second].uri = peer.uri; // keep the most recent uri
+    }
+    return it->second;
+  }
+
+  std::vector<peer_handle_t> intern(const std::vector<PeerInformation> &peers) {
+    std::vector<peer_handle_t> result;
+    result.reserve(peers.size());
+    for (const auto &peer : peers) {
+      result.push_back(intern(peer));
+    }
+    return result;
+  }
+
+  /**
+   * @param id
+   * @return the handle of the peer with the given id or kNoPeer if it has not been registered
+   */
+  peer_handle_t find(uint64_t id) const {
+    auto it = handle_for_id_.find(id);
+    return it != handle_for_id_.end() ? it->second : kNoPeer;
+  }
+
+  const PeerInformation &at(peer_handle_t handle) const {
+    return peers_.at(handle);
+  }
+
+  /** the number of registered peers (all handles are smaller) */
+  size_t size() const {
+    return peers_.size();
+  }
+};
+
+}
+
+#endif //NETWORK_SGX_EXAMPLE_PEER_REGISTRY_H
@@ -0,0 +1,86 @@
+#ifndef NETWORK_SGX_EXAMPLE_PEER_SET_H
+#define NETWORK_SGX_EXAMPLE_PEER_SET_H
+
+#include <vector>
+#include <unordered_set>
+#include "../../../include/shared_structs.h"
+
+namespace c1::client {
+
+/**
+ * A set of peers that keeps the order of insertion (like the vectors used in the paper) but deduplicates by peer id
+ * in constant time.
+ */
+class PeerSet {
+  std::vector<PeerInformation> peers_;
+  std::unordered_set<uint64_t> ids_;
+
+ public:
+  PeerSet() = default;
+
+  explicit PeerSet(const std::vector<PeerInformation> &peers) {
+    insert(peers);
+  }
+
+  /**
+   * Adds peer to the set if no peer with the same id is contained yet.
+   * @return true if peer has been added
+   */
+  bool insert(const PeerInformation &peer) {
+    if (!ids_.insert(peer.id).second) {
+      return false;
+    }
+    peers_.push_back(peer);
+    return true;
+  }
+
+  void insert(const std::vector<PeerInformation> &peers) {
+    peers_.reserve(peers_.size() + peers.size());
+    ids_.reserve(ids_.size() + peers.size());
+    for (const auto &peer : peers) {
+      insert(peer);
+    }
+  }
+
+  bool contains(uint64_t id) const {
+    return ids_.count(id) != 0;
+  }
+
+  size_t size() const {
+    return peers_.size();
+  }
+
+  bool empty() const {
+    return peers_.empty();
+  }
+
+  void clear() {
+    peers_.clear();
+    ids_.clear();
+  }
+
+  /** the peers in order of insertion */
+  const std::vector<PeerInformation> &peers() const {
+    return peers_;
+  }
+
+  /** moves the peers out of the set (in order of insertion) and leaves the set empty */
+  std::vector<PeerInformation> release() {
+    std::vector<PeerInformation> result = std::move(peers_);
+    peers_.clear();
+    ids_.clear();
+    return result;
+  }
+
+  std::vector<PeerInformation>::const_iterator begin() const {
+    return peers_.begin();
+  }
+
+  std::vector<PeerInformation>::const_iterator end() const {
+    return peers_.end();
+  }
+};
+
+}
+
+#endif //NETWORK_SGX_EXAMPLE_PEER_SET_H
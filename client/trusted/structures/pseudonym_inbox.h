@@ -0,0 +1,75 @@
+#ifndef NETWORK_SGX_EXAMPLE_PSEUDONYM_INBOX_H
+#define NETWORK_SGX_EXAMPLE_PSEUDONYM_INBOX_H
+
+#include <vector>
+#include <map>
+#include <algorithm>
+#include "../structures.h"
+
+namespace c1::client {
+
+/**
+ * The sets q_in (see paper) of all local pseudonyms, indexed by their local number. The messages of a pseudonym are
+ * bucketed by the round of their t_dst, so that only the earliest bucket has to be looked at to find the due ones.
+ */
+class PseudonymInbox {
+  typedef std::map<round_t, std::vector<MessageTuple>> Buckets;
+  std::vector<Buckets> buckets_for_pseudonym_;
+  size_t size_ = 0;
+
+ public:
+  /** adds a q_in for the next local pseudonym */
+  void add_pseudonym() {
+    buckets_for_pseudonym_.emplace_back();
+  }
+
+  size_t num_pseudonyms() const {
+    return buckets_for_pseudonym_.size();
+  }
+
+  void push(uint8_t local_num, const MessageTuple &message) {
+    buckets_for_pseudonym_.at(local_num)[calculate_round_from_t(message.t_dst)].push_back(message);
+    size_++;
+  }
+
+  /**
+   * Takes out the messages of pseudonym local_num that are due (t_dst <= now), ordered by t_dst.
+   * @param local_num
+   * @param now
+   * @param max_messages at most this many messages are taken out (the others stay)
+   * @param out the messages are appended to out
+   * @return the number of messages taken out
+   */
+  size_t pop_due(uint8_t local_num, uint64_t now, size_t max_messages, std::vector<MessageTuple> &out) {
+    auto &buckets = buckets_for_pseudonym_.at(local_num);
+    auto first = out.size();
+    auto cur_round = calculate_round_from_t(now);
+    for (auto it = buckets.begin(); it != buckets.end() && it->first <= cur_round && out.size() - first < max_messages;) {
+      auto &bucket = it->second;
+      std::sort(bucket.begin(), bucket.end(), [](const MessageTuple &lhs, const MessageTuple &rhs) {
+        return lhs.t_dst < rhs.t_dst;
+      });
+      auto due_end = std::upper_bound(bucket.begin(), bucket.end(), now, [](uint64_t t, const MessageTuple &message) {
+        return t < message.t_dst;
+      });
+      auto num = std::min(static_cast<size_t>(due_end - bucket.begin()), max_messages - (out.size() - first));
+      out.insert(out.end(), bucket.begin(), bucket.begin() + num);
+      bucket.erase(bucket.begin(), bucket.begin() + num);
+      if (!bucket.empty()) {
+        break; // the remaining messages are not due yet (or max_messages has been reached)
+      }
+      it = buckets.erase(it);
+    }
+    size_ -= out.size() - first;
+    return out.size() - first;
+  }
+
+  /** the number of messages of all pseudonyms (due or not) */
+  size_t size() const {
+    return size_;
+  }
+};
+
+}
+
+#endif //NETWORK_SGX_EXAMPLE_PSEUDONYM_INBOX_H
@@ -0,0 +1,73 @@
+#ifndef NETWORK_SGX_EXAMPLE_TRAFFIC_OUT_RECORDER_H
+#define NETWORK_SGX_EXAMPLE_TRAFFIC_OUT_RECORDER_H
+
+#include <cstdint>
+#include "../../include/enclave_stats.h"
+
+namespace c1::client {
+
+/**
+ * Records the phase timers of traffic_out (see traffic_out_stats_t). The phases are timed back to back:
+ * end_phase() accounts the time since the previous boundary, so that a round needs one clock reading per phase.
+ */
+class TrafficOutRecorder {
+ public:
+  /** returns the current time in nanoseconds */
+  typedef uint64_t (*Clock)();
+
+ private:
+  Clock clock_;
+  uint64_t phase_start_ = 0;
+  traffic_out_round_stats_t current_{};
+  traffic_out_stats_t stats_{};
+
+  static uint64_t total_ns(const traffic_out_round_stats_t &round) {
+    uint64_t result = 0;
+    for (auto ns : round.phase_ns) {
+      result += ns;
+    }
+    return result;
+  }
+
+ public:
+  explicit TrafficOutRecorder(Clock clock) : clock_(clock) {}
+
+  void begin_round() {
+    current_ = traffic_out_round_stats_t{};
+    current_.rounds = 1;
+    phase_start_ = clock_();
+  }
+
+  /** ends phase (which has run since the previous boundary) */
+  void end_phase(traffic_out_phase_t phase) {
+    auto now = clock_();
+    current_.phase_ns[phase] += now >= phase_start_ ? now - phase_start_ : 0; // (a failed clock reading returns 0)
+    phase_start_ = now;
+  }
+
+  void end_round(uint64_t round) {
+    stats_.last_round_number = round;
+    stats_.last_round = current_;
+    if (total_ns(current_) >= total_ns(stats_.slowest_round)) {
+      stats_.slowest_round = current_;
+    }
+    auto &total = stats_.total;
+    total.rounds += current_.rounds;
+    for (int phase = 0; phase < TRAFFIC_OUT_NUM_PHASES; ++phase) {
+      total.phase_ns[phase] += current_.phase_ns[phase];
+    }
+  }
+
+  /** sets the counters of the round arena (see traffic_out_arena_stats_t) */
+  void set_arena(const traffic_out_arena_stats_t &arena) {
+    stats_.arena = arena;
+  }
+
+  const traffic_out_stats_t &stats() const {
+    return stats_;
+  }
+};
+
+}
+
+#endif //NETWORK_SGX_EXAMPLE_TRAFFIC_OUT_RECORDER_H
@@ -7,6 +7,7 @@
 #include <unistd.h>
 #include <pwd.h>
 #include <iostream>
+#include <algorithm>
 
 #include "enclave_u.h"
 #include "sgx_urts.h"
@@ -16,6 +17,10 @@
 # define ENCLAVE_FILENAME "enclave_client.signed.so"
 # define MAX_PATH FILENAME_MAX
 
+#ifndef BUILD_PROFILE
+# define BUILD_PROFILE "unknown"
+#endif
+
 #ifndef TRUE
 # define TRUE 1
 #endif
@@ -96,7 +101,7 @@ int Client::initialize_enclave() {
   return 0;
 }
 
-int Client::run() {
+int Client::run(uint16_t login_server_port) {
   /* Initialize the enclave */
   if (initialize_enclave() < 0) {
     printf("Enter a character before exit ...\n");
@@ -107,6 +112,7 @@ int Client::run() {
   ecall_init(global_eid_);
 
   /* Inform the network manager of the global_eid_ */
+  network_manager_.connect_to_server(login_server_port);
   network_manager_.set_global_sgx_eid_and_network_init(global_eid_);
 
   //main loop
@@ -121,18 +127,15 @@ int Client::run() {
     std::chrono::duration<double> time_diff = std::chrono::system_clock::now() - start;
     if (time_diff.count() >= static_cast<double>(kDelta) / 2.0) {
       int ret_val;
+      auto round_start = std::chrono::steady_clock::now();
       ecall_traffic_out(global_eid_, &ret_val);
+      record_round_time(std::chrono::steady_clock::now() - round_start);
       start = std::chrono::system_clock::now();
-    }
-
-    { //try to receive messages
-      int retval;
-      UserInterfaceMessageInjectionCommand msg; // slight abuse of notation
-      ecall_receive_message(global_eid_, &retval, msg.n_dst, msg.msg, msg.n_src, &msg.t_dst);
-      if (retval) {
-        std::cout << "Received message: " << reinterpret_cast<char *>(msg.msg) << std::endl;
+      if (ret_val) {
+        print_traffic_in_stats();
       }
     }
+    receive_messages();
 
   }
 
@@ -146,6 +149,110 @@ int Client::run() {
   return 0;
 }
 
+void Client::messages_delivered(uint8_t local_num, uint64_t num_messages, uint64_t due_in) {
+  if (local_num >= pending_deliveries_.size()) {
+    pending_deliveries_.resize(local_num + 1);
+  }
+  auto &pending = pending_deliveries_[local_num];
+  auto due_at = std::chrono::steady_clock::now() + std::chrono::seconds(due_in);
+  if (pending.num_messages == 0 || due_at < pending.due_at) {
+    pending.due_at = due_at;
+  }
+  pending.num_messages += num_messages;
+}
+
+void Client::receive_messages() {
+  static constexpr size_t kMaxMessages = 64;
+  received_message_t messages[kMaxMessages];
+  const auto &pseudonyms = network_manager_.local_pseudonyms();
+  auto now = std::chrono::steady_clock::now();
+  for (size_t local_num = 0; local_num < pending_deliveries_.size() && local_num < pseudonyms.size(); ++local_num) {
+    auto &pending = pending_deliveries_[local_num];
+    if (pending.num_messages == 0 || pending.due_at > now) {
+      continue; // nothing to fetch (no enclave transition needed)
+    }
+    auto pseudonym = pseudonyms[local_num];
+    size_t num_messages;
+    do {
+      ecall_receive_messages(global_eid_, &num_messages, pseudonym.data(), messages, kMaxMessages);
+      for (size_t i = 0; i < num_messages; ++i) {
+        UserInterfaceReceivedMessage received;
+        std::copy(std::begin(messages[i].n_src), std::end(messages[i].n_src), received.n_src);
+        std::copy(std::begin(messages[i].msg), std::end(messages[i].msg), received.msg);
+        received.t_dst = messages[i].t_dst;
+        network_manager_.publish_received_message(pseudonym, received);
+        std::string msg(reinterpret_cast<char *>(received.msg), kMessageSize);
+        std::cout << "Received message: " << msg.c_str() << std::endl;
+      }
+      pending.num_messages -= std::min<uint64_t>(pending.num_messages, num_messages);
+    } while (num_messages == kMaxMessages);
+    if (pending.num_messages != 0) {
+      // the remaining messages are due later (the time of the enclave has a resolution of a second)
+      pending.due_at = now + std::chrono::seconds(1);
+    }
+  }
+}
+
+void Client::print_traffic_in_stats() {
+  traffic_in_stats_t stats;
+  ecall_get_traffic_in_stats(global_eid_, &stats);
+  std::cout << "traffic_in: " << stats.received_messages << " messages (" << stats.received_bytes << " bytes), "
+            << stats.accepted_messages << " accepted, rejected: " << stats.rejected_malformed << " malformed, "
+            << stats.rejected_misaddressed << " misaddressed, " << stats.rejected_stale << " stale, "
+            << stats.rejected_early << " early, " << stats.rejected_replayed << " replayed, "
+            << stats.rejected_unauthenticated << " unauthenticated (" << stats.rejected_bytes << " bytes, "
+            << stats.rejected_bytes_undecrypted << " of them not decrypted)" << std::endl;
+}
+
+void Client::record_round_time(std::chrono::steady_clock::duration round_time) {
+  round_times_.num_rounds++;
+  round_times_.total += round_time;
+  round_times_.max = std::max(round_times_.max, round_time);
+  if (round_times_.num_rounds < kRoundTimeReportInterval) {
+    return;
+  }
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  std::cout << "round time [" << BUILD_PROFILE << "]: mean "
+            << Milliseconds(round_times_.total).count() / round_times_.num_rounds << " ms, max "
+            << Milliseconds(round_times_.max).count() << " ms (traffic_out, " << round_times_.num_rounds << " rounds)"
+            << std::endl;
+  round_times_ = RoundTimes();
+  print_traffic_out_stats();
+}
+
+void Client::print_traffic_out_stats() {
+  static const char *const kPhaseNames[TRAFFIC_OUT_NUM_PHASES] =
+      {"overlay", "announce", "agreement update", "agreement finalize", "inject", "routing", "delivery", "padding",
+       "sealing", "inbox rotation", "output"};
+  traffic_out_stats_t stats;
+  ecall_get_traffic_out_stats(global_eid_, &stats);
+  // the means are taken over the rounds since the previous report
+  const auto &total = stats.total;
+  const auto &previous = previous_traffic_out_total_;
+  auto rounds = total.rounds - previous.rounds;
+  if (rounds == 0) {
+    return;
+  }
+  auto per_round = [rounds](uint64_t cur, uint64_t prev) { return static_cast<double>(cur - prev) / rounds; };
+  uint64_t slowest_ns = 0;
+  for (auto ns : stats.slowest_round.phase_ns) {
+    slowest_ns += ns;
+  }
+  std::cout << "traffic_out phases (mean ms per round over " << rounds << " rounds, slowest round so far "
+            << slowest_ns / 1e6 << " ms):";
+  for (int phase = 0; phase < TRAFFIC_OUT_NUM_PHASES; ++phase) {
+    std::cout << (phase == 0 ? " " : ", ") << kPhaseNames[phase] << " "
+              << per_round(total.phase_ns[phase], previous.phase_ns[phase]) / 1e6;
+  }
+  std::cout << std::endl;
+  if (stats.arena.heap_blocks != 0) { // (only exported by debug enclaves)
+    std::cout << "traffic_out arena: " << stats.arena.last_round_allocations << " allocations in round "
+              << stats.last_round_number << ", peak " << stats.arena.peak_bytes << " bytes, "
+              << stats.arena.heap_blocks << " heap blocks" << std::endl;
+  }
+  previous_traffic_out_total_ = total;
+}
+
 void Client::send_msg_to_server(const void *ptr, size_t len) {
   network_manager_.send_msg_to_server(ptr, len);
 }
@@ -182,3 +289,12 @@ void ocall_send_msg_to_server(const uint8_t *ptr, size_t len) {
 void ocall_traffic_out_return(const uint8_t *ptr, size_t len) {
   c1::client::Client::instance().traffic_out_return(ptr, len);
 }
+
+void ocall_messages_delivered(uint8_t local_num, uint64_t num_messages, uint64_t due_in) {
+  c1::client::Client::instance().messages_delivered(local_num, num_messages, due_in);
+}
+
+uint64_t ocall_get_time_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -7,10 +7,16 @@
 
 #include <network/network_manager.h>
 #include <sgx_eid.h>
+#include "../../include/enclave_stats.h"
 #include <cstdio>
+#include <chrono>
+#include <vector>
 
 namespace c1::client {
 
+/** the mean and the maximum round time are printed every this many rounds */
+constexpr uint64_t kRoundTimeReportInterval{20};
+
 /** Base peer class */
 class Client {
  public:
@@ -23,8 +29,11 @@ class Client {
     return INSTANCE;
   }
 
-  /** main loop (infinite) */
-  int run();
+  /**
+   * main loop (infinite)
+   * @param login_server_port the port of the login server (of the shard to join at if it is sharded)
+   */
+  int run(uint16_t login_server_port = kLoginServerPort);
 
   void send_msg_to_server(const void *ptr, size_t len);
   /**
@@ -33,15 +42,49 @@ class Client {
    * @param len its length
    */
   void traffic_out_return(const uint8_t *ptr, size_t len);
+  /**
+   * Called by the enclave whenever messages have been delivered to a local pseudonym.
+   * @param local_num the local number of the pseudonym (i.e., the order in which the pseudonyms have been generated)
+   * @param num_messages
+   * @param due_in seconds until the first of these messages is due
+   */
+  void messages_delivered(uint8_t local_num, uint64_t num_messages, uint64_t due_in);
 
  private:
   Client();
 
   int initialize_enclave();
 
+  /** fetches the due messages of the local pseudonyms (in batches) from the enclave and publishes them */
+  void receive_messages();
+
+  /** prints the counters of traffic_in (see enclave_stats.h) */
+  void print_traffic_in_stats();
+
+  /** accounts the time a traffic_out call took and prints the round times every kRoundTimeReportInterval rounds */
+  void record_round_time(std::chrono::steady_clock::duration round_time);
+
+  /** prints the phase timers and counters of traffic_out (see enclave_stats.h) since the previous call */
+  void print_traffic_out_stats();
+
   /* Global EID shared by multiple threads */
   sgx_enclave_id_t global_eid_ = 0;
   network_manager network_manager_;
+  /** the messages delivered to a local pseudonym (announced via messages_delivered) that have not been fetched yet */
+  struct PendingDelivery {
+    uint64_t num_messages = 0;
+    std::chrono::steady_clock::time_point due_at;
+  };
+  /** indexed by the local number of the pseudonym */
+  std::vector<PendingDelivery> pending_deliveries_;
+  /** the round times since the last report (tagged with the build profile, so that the presets can be compared) */
+  struct RoundTimes {
+    uint64_t num_rounds = 0;
+    std::chrono::steady_clock::duration total{0};
+    std::chrono::steady_clock::duration max{0};
+  } round_times_;
+  /** the totals of the traffic_out stats at the previous report */
+  traffic_out_round_stats_t previous_traffic_out_total_{};
 };
 
 } // ~namespace
@@ -53,6 +96,8 @@ extern "C" {
 void ocall_print_string(const char *str);
 void ocall_send_msg_to_server(const uint8_t *ptr, size_t len);
 void ocall_traffic_out_return(const uint8_t *ptr, size_t len);
+void ocall_messages_delivered(uint8_t local_num, uint64_t num_messages, uint64_t due_in);
+uint64_t ocall_get_time_ns();
 
 #if defined(__cplusplus)
 }
@@ -1,6 +1,9 @@
+#include <string>
 #include "client.h"
 
 int main(int argc, char *argv[]) {
   using namespace c1::client;
-  return Client::instance().run();
+  // the port of the login server can be given as first argument (to join at a shard of a sharded login server)
+  uint16_t login_server_port = argc > 1 ? std::stoul(argv[1]) : kLoginServerPort;
+  return Client::instance().run(login_server_port);
 }
\ No newline at end of file
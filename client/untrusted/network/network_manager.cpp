@@ -5,6 +5,7 @@
 #include "network_manager.h"
 #include <enclave_u.h>
 #include <iostream>
+#include <algorithm>
 
 namespace c1::client {
 
@@ -16,14 +17,15 @@ network_manager::network_manager() : context_(1), server_socket_out_(context_, Z
                                      global_sgx_eid_(0),
                                      pollitems_{server_and_peer_socket_in_, 0, ZMQ_POLLIN, 0},
                                      user_socket_in_{context_, ZMQ_PULL},
-                                     pollitems_user_{user_socket_in_, 0, ZMQ_POLLIN, 0} {
-  server_socket_out_.connect("tcp://localhost:5671");
+                                     pollitems_user_{user_socket_in_, 0, ZMQ_POLLIN, 0},
+                                     user_socket_out_{context_, ZMQ_PUB} {
   std::string id("client"
                      + std::to_string(std::chrono::system_clock::now().time_since_epoch().count()));
   server_socket_out_.setsockopt(ZMQ_IDENTITY, id.c_str(), id.length()); //  Set a printable identity
   server_socket_out_.setsockopt(ZMQ_LINGER, 0);
   server_and_peer_socket_in_.setsockopt(ZMQ_LINGER, 0);
   user_socket_in_.setsockopt(ZMQ_LINGER, 0);
+  user_socket_out_.setsockopt(ZMQ_LINGER, 0);
 
   char uri_chars[1024]; //make this sufficiently large.
   //otherwise an error will be thrown because of invalid argument.
@@ -53,6 +55,18 @@ network_manager::network_manager() : context_(1), server_socket_out_(context_, Z
 
   std::cout << "user socket is bound at port: " << user_port << std::endl;
 
+  // establish the socket the received messages are published on:
+  try {
+    user_socket_out_.bind("tcp://*:*");
+  }
+  catch (zmq::error_t &e) {
+    std::cerr << "couldn't bind to socket (for received messages): " << e.what();
+    abort();
+  }
+  size = sizeof(uri_chars);
+  user_socket_out_.getsockopt(ZMQ_LAST_ENDPOINT, &uri_chars, &size);
+  std::cout << "received messages are published at port: " << get_port_from_uri(uri_chars) << std::endl;
+
 }
 int network_manager::get_port_from_uri(const char *uri_chars) {
   auto uri_str = std::string(uri_chars);
@@ -93,20 +107,37 @@ bool network_manager::MainLoop() {
     //assert(msg_content.size() == 1);
     char message_type = *static_cast<char *>(msg_content.data());
     switch (message_type) {
-      case 0: assert(msg_content.size() == 1);
+      case kUserCommandGeneratePseudonym: assert(msg_content.size() == 1);
         uint8_t pseud[kPseudonymSize];
         ecall_generate_pseudonym(global_sgx_eid_, pseud);
+        if (std::all_of(pseud, pseud + kPseudonymSize, [](uint8_t byte) { return byte == 0; })) {
+          std::cout << "No further pseudonym can be generated" << std::endl;
+          break;
+        }
+        local_pseudonyms_.emplace_back();
+        std::copy(pseud, pseud + kPseudonymSize, local_pseudonyms_.back().begin());
         std::cout << "Pseudonym is: ";
         for (int i = 0; i < kPseudonymSize; ++i) {
           std::cout << std::to_string(pseud[i]) << " ";
         }
         std::cout << std::endl;
+        publish_generated_pseudonym(local_pseudonyms_.back());
         break;
-      case 1:
+      case kUserCommandSendMessage: {
         auto injection =
             *reinterpret_cast<UserInterfaceMessageInjectionCommand *>(static_cast<char *>(msg_content.data()) + 1);
         ecall_send_message(global_sgx_eid_, injection.n_src, injection.msg, injection.n_dst, injection.t_dst);
         break;
+      }
+      case kUserCommandSendMessages: {
+        auto num_commands = (msg_content.size() - 1) / sizeof(UserInterfaceMessageInjectionCommand);
+        // copied, as the commands are not aligned within the message
+        std::vector<injection_command_t> commands(num_commands);
+        memcpy(commands.data(), static_cast<char *>(msg_content.data()) + 1, num_commands * sizeof(injection_command_t));
+        size_t num_queued;
+        ecall_send_messages(global_sgx_eid_, &num_queued, commands.data(), commands.size());
+        break;
+      }
     }
   }
 
@@ -116,6 +147,10 @@ bool network_manager::MainLoop() {
   return true;
 }
 
+void network_manager::connect_to_server(uint16_t port) {
+  server_socket_out_.connect("tcp://localhost:" + std::to_string(port));
+}
+
 void network_manager::set_global_sgx_eid_and_network_init(sgx_enclave_id_t global_sgx_eid_) {
   network_manager::global_sgx_eid_ = global_sgx_eid_;
   ecall_network_init(global_sgx_eid_, 127, 0, 0, 1, in_port_);
@@ -145,6 +180,31 @@ void network_manager::send_msg_to_peer(const PeerInformation &peer, const uint8_
   //return (rc);
 }
 
+void network_manager::publish_generated_pseudonym(const std::array<uint8_t, kPseudonymSize> &pseudonym) {
+  UserInterfaceGeneratedPseudonym generated;
+  std::copy(pseudonym.begin(), pseudonym.end(), generated.pseudonym);
+  ecall_get_time(global_sgx_eid_, &generated.time);
+
+  zmq::message_t topic(sizeof(kTopicGeneratedPseudonym) - 1);
+  memcpy(topic.data(), kTopicGeneratedPseudonym, topic.size());
+  zmq::message_t content(sizeof(generated));
+  memcpy(content.data(), &generated, sizeof(generated));
+
+  user_socket_out_.send(topic, ZMQ_SNDMORE);
+  user_socket_out_.send(content);
+}
+
+void network_manager::publish_received_message(const std::array<uint8_t, kPseudonymSize> &n_dst,
+                                               const UserInterfaceReceivedMessage &message) {
+  zmq::message_t topic(n_dst.size());
+  memcpy(topic.data(), n_dst.data(), n_dst.size());
+  zmq::message_t content(sizeof(message));
+  memcpy(content.data(), &message, sizeof(message));
+
+  user_socket_out_.send(topic, ZMQ_SNDMORE);
+  user_socket_out_.send(content);
+}
+
 network_manager::~network_manager() {
   server_socket_out_.close();
 }
@@ -32,6 +32,12 @@ class network_manager {
    */
   virtual ~network_manager();
 
+  /**
+   * Connect to the login server (or the shard of it) listening on port, before the join message is sent.
+   * @param port
+   */
+  void connect_to_server(uint16_t port);
+
   /**
    * Called once the global_sgx_eid is available.
    * @param global_sgx_eid_
@@ -57,6 +63,18 @@ class network_manager {
    * @param len
    */
   void send_msg_to_peer(const PeerInformation &peer, const uint8_t *ptr, size_t len);
+  /**
+   * Publish a generated pseudonym to the peer interfaces (under the topic kTopicGeneratedPseudonym).
+   * @param pseudonym
+   */
+  void publish_generated_pseudonym(const std::array<uint8_t, kPseudonymSize> &pseudonym);
+  /**
+   * Publish a received message to the peer interfaces that subscribed to its destination pseudonym.
+   * @param n_dst the destination pseudonym (used as topic)
+   * @param message
+   */
+  void publish_received_message(const std::array<uint8_t, kPseudonymSize> &n_dst,
+                                const UserInterfaceReceivedMessage &message);
 
  private:
   /** zeromq context */
@@ -73,6 +91,8 @@ class network_manager {
   zmq::pollitem_t pollitems_[1];
   /** poller for the peer interface in-socket */
   zmq::pollitem_t pollitems_user_[1];
+  /** the outgoing socket the received messages are published on (to the peer interface) */
+  zmq::socket_t user_socket_out_;
   /** port of server_and_peer_socket_in_ */
   int in_port_;
   std::string hostname_;
@@ -80,6 +100,8 @@ class network_manager {
   std::unordered_map<uint64_t, Peer> peers_;
   /** whether the system has already been initialized (login server's work is done, all peers have joined the system) */
   bool initialized = false;
+  /** see local_pseudonyms() */
+  std::vector<std::array<uint8_t, kPseudonymSize>> local_pseudonyms_;
 
  public:
   /**
@@ -87,6 +109,11 @@ class network_manager {
    * @return
    */
   bool isInitialized() const;
+
+  /** the pseudonyms generated (via the user interface) for this node so far */
+  const std::vector<std::array<uint8_t, kPseudonymSize>> &local_pseudonyms() const {
+    return local_pseudonyms_;
+  }
  private:
 
   int get_port_from_uri(const char *uri_chars);
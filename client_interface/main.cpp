@@ -46,14 +46,14 @@ int main(int argc, char *argv[]) {
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wmissing-noreturn"
   while (true) {
-    std::cout << "Please choose: \n(1) Create pseudonym \n(2) Send Message\nYour choice: ";
+    std::cout << "Please choose: \n(1) Create pseudonym \n(2) Send Message\n(3) Receive messages\nYour choice: ";
     std::string answer_str;
     std::getline(std::cin, answer_str);
     auto answer_int = std::stoi(answer_str);
 
     if (answer_int == 1) {
       zmq::message_t message(1);
-      memset(message.data(), 0, 1);
+      static_cast<char *>(message.data())[0] = kUserCommandGeneratePseudonym;
       bool rc = socket_out.send(message);
       if (!rc) { return -1; };
     }
@@ -97,11 +97,42 @@ int main(int argc, char *argv[]) {
 
       // send message
       zmq::message_t message(sizeof(injection_message) + 1);
-      static_cast<char *>(message.data())[0] = 1;
+      static_cast<char *>(message.data())[0] = kUserCommandSendMessage;
       memcpy(static_cast<char *>(message.data()) + 1, &injection_message, sizeof(injection_message));
       bool rc = socket_out.send(message);
       if (!rc) { return -1; };
     }
+    if (answer_int == 3) {
+      std::string receive_port;
+      std::cout << "Please enter the port the client publishes received messages at: ";
+      std::getline(std::cin, receive_port);
+
+      // the destination pseudonym is used as topic
+      std::cout << "Please enter the destination pseudonym (n_dst): ";
+      std::string pseud_dst_string;
+      std::getline(std::cin, pseud_dst_string);
+      auto pseud_dst_vec = obtain_pseudonym_from_user_string(pseud_dst_string);
+      if (!pseud_dst_vec.has_value()) {
+        continue;
+      }
+
+      zmq::socket_t socket_in(context, ZMQ_SUB);
+      socket_in.setsockopt(ZMQ_LINGER, 0);
+      socket_in.connect("tcp://localhost:" + receive_port);
+      socket_in.setsockopt(ZMQ_SUBSCRIBE, pseud_dst_vec.value().data(), pseud_dst_vec.value().size());
+      while (true) { // receive until the interface is terminated
+        zmq::message_t topic;
+        zmq::message_t content;
+        socket_in.recv(&topic);
+        socket_in.recv(&content);
+        if (content.size() != sizeof(UserInterfaceReceivedMessage)) {
+          continue;
+        }
+        auto received = *static_cast<UserInterfaceReceivedMessage *>(content.data());
+        std::string message_string(reinterpret_cast<char *>(received.msg), kMessageSize);
+        std::cout << "Received message (t_dst " << received.t_dst << "): " << message_string.c_str() << std::endl;
+      }
+    }
 
 
     /*
@@ -32,6 +32,9 @@ constexpr int kSend{1};
 /** variable k_recv as in the paper */
 constexpr int kRecv{2};
 
+/** port of the login server (shard k of a sharded login server listens on kLoginServerPort + k) */
+constexpr uint16_t kLoginServerPort{5671};
+
 typedef uint64_t round_t;
 typedef uint64_t onid_t;
 
@@ -2,9 +2,12 @@
 // Created by c1 on 25.05.18.
 //
 
+#include <cstdlib>
 #include <sgx_trts.h>
 #include "cryptlib.h"
+#ifndef OUTSIDE_ENCLAVE
 #include "enclave_t.h"
+#endif
 
 #define ASSERT(x) \
   if (!(x)) { \
@@ -12,6 +15,12 @@
   } \
   assert (x);
 
+/** like assert, but also checked with NDEBUG (for failures the enclave must not continue after) */
+#define ABORT_UNLESS(x) \
+  if (!(x)) { \
+    abort(); \
+  }
+
 namespace c1 {
 
 std::vector<uint8_t> cryptlib::encrypt(const sgx_aes_gcm_128bit_key_t &sk_enc,
@@ -32,66 +41,91 @@ std::vector<uint8_t> cryptlib::encrypt(const sgx_aes_gcm_128bit_key_t &sk_enc,
 
   //Generate random IV and write it to result
   uint8_t iv[SGX_AESGCM_IV_SIZE];
-  assert(sgx_read_rand(iv, SGX_AESGCM_IV_SIZE) == SGX_SUCCESS);
+  auto rand_status = sgx_read_rand(iv, SGX_AESGCM_IV_SIZE);
+  ABORT_UNLESS(rand_status == SGX_SUCCESS); // never encrypt with a predictable iv
   result.insert(result.end(), &iv[0], &iv[SGX_AESGCM_IV_SIZE]);
 
   //Copy aad to result
   result.insert(result.end(), aad.begin(), aad.end());
 
   //Encrypt p(lct) with additional authenticated data: lct(sizeof(uint32_t)) || laad(sizeof(uint32_t)) || iv(SGX_AESGCM_IV_SIZE) || aad(laad)
-  uint8_t ciphertext_out[lct];
+  std::vector<uint8_t> ciphertext_out(lct);
   uint8_t mac_out[SGX_AESGCM_MAC_SIZE];
   auto status = sgx_rijndael128GCM_encrypt(&sk_enc,
           p.data(), lct,
-          ciphertext_out,
+          ciphertext_out.data(),
           iv, SGX_AESGCM_IV_SIZE, //todo iv length can be chosen more cleverly knowing how much data we encrypt at most with each IV
           result.data(), sizeof(uint32_t) + sizeof(uint32_t) + SGX_AESGCM_IV_SIZE + laad, //aad for GCM
           &mac_out);
-  assert(status == SGX_SUCCESS);
+  ABORT_UNLESS(status == SGX_SUCCESS);
 
   //Append MAC and ciphertext to the result
   result.insert(result.end(), &mac_out[0], &mac_out[SGX_AESGCM_MAC_SIZE]);
-  result.insert(result.end(), &ciphertext_out[0], &ciphertext_out[lct]);
+  result.insert(result.end(), ciphertext_out.begin(), ciphertext_out.end());
 
   return result;
 }
 
-std::pair<std::vector<uint8_t>, std::vector<uint8_t>> cryptlib::decrypt(const sgx_aes_gcm_128bit_key_t &sk_enc,
-                                                                        const std::vector<uint8_t> &c) {
-  size_t cur = 0;
-  auto lct = deserialize_number<uint32_t>(c, cur);
-  auto laad = deserialize_number<uint32_t>(c, cur);
-  const uint8_t* iv = &c[sizeof(uint32_t) + sizeof(uint32_t)];
-  const uint8_t* aad = &c[sizeof(uint32_t) + sizeof(uint32_t) + SGX_AESGCM_IV_SIZE];
-  const uint8_t* mac = &c[sizeof(uint32_t) + sizeof(uint32_t) + SGX_AESGCM_IV_SIZE + laad];
-  const uint8_t* ct = &c[sizeof(uint32_t) + sizeof(uint32_t) + SGX_AESGCM_IV_SIZE + laad + SGX_AESGCM_MAC_SIZE];
-  const uint8_t* gcmaad = &c[0];
-  assert(c.size() == sizeof(uint32_t) + sizeof(uint32_t) + SGX_AESGCM_IV_SIZE + laad + SGX_AESGCM_MAC_SIZE + lct);
+bool cryptlib::decrypt(const sgx_aes_gcm_128bit_key_t &sk_enc,
+                       const std::vector<uint8_t> &c,
+                       std::vector<uint8_t> &p,
+                       std::vector<uint8_t> &aad) {
+  std::vector<uint8_t> buffer(c);
+  CiphertextRanges ranges;
+  if (!decrypt_in_place(sk_enc, buffer, ranges)) {
+    return false;
+  }
+  p.assign(buffer.begin() + ranges.p_begin, buffer.begin() + ranges.p_begin + ranges.p_len);
+  aad.assign(buffer.begin() + ranges.aad_begin, buffer.begin() + ranges.aad_begin + ranges.aad_len);
+  return true;
+}
 
-  //Copy MAC to please sgx_rijndael128GCM_decrypt's input requirements
-  const uint8_t mac_tag[SGX_AESGCM_MAC_SIZE] = {mac[0], mac[1], mac[2], mac[3], mac[4], mac[5], mac[6], mac[7],
-                                                mac[8], mac[9], mac[10], mac[11], mac[12], mac[13], mac[14], mac[15]};
+bool cryptlib::get_ranges(const uint8_t *c, size_t len, CiphertextRanges &ranges) {
+  constexpr size_t header_size = sizeof(uint32_t) + sizeof(uint32_t) + SGX_AESGCM_IV_SIZE;
+  if (len < header_size + SGX_AESGCM_MAC_SIZE) {
+    return false;
+  }
+  auto read_uint32 = [c](size_t cur) { // see serialize_number
+    return (static_cast<uint32_t>(c[cur]) << 24) | (static_cast<uint32_t>(c[cur + 1]) << 16)
+        | (static_cast<uint32_t>(c[cur + 2]) << 8) | static_cast<uint32_t>(c[cur + 3]);
+  };
+  size_t lct = read_uint32(0);
+  size_t laad = read_uint32(sizeof(uint32_t));
+  if (len != header_size + laad + SGX_AESGCM_MAC_SIZE + lct) {
+    return false;
+  }
+  ranges.aad_begin = header_size;
+  ranges.aad_len = laad;
+  ranges.p_begin = header_size + laad + SGX_AESGCM_MAC_SIZE;
+  ranges.p_len = lct;
+  return true;
+}
 
-  //Decrypt
-  uint8_t plaintext[lct];
-  auto status = sgx_rijndael128GCM_decrypt(&sk_enc,
-          ct, lct,
-          plaintext,
-          iv, SGX_AESGCM_IV_SIZE,
-          gcmaad, sizeof(uint32_t) + sizeof(uint32_t) + SGX_AESGCM_IV_SIZE + laad,
-          &mac_tag);
-  assert(status == SGX_SUCCESS);
+bool cryptlib::decrypt_in_place(const sgx_aes_gcm_128bit_key_t &sk_enc,
+                                std::vector<uint8_t> &c,
+                                CiphertextRanges &ranges) {
+  if (!get_ranges(c.data(), c.size(), ranges)) {
+    return false;
+  }
 
-  std::vector<uint8_t> resultPlaintext(plaintext, plaintext+lct);
-  std::vector<uint8_t> resultAad(aad, aad+laad);
+  //Copy MAC to please sgx_rijndael128GCM_decrypt's input requirements
+  sgx_aes_gcm_128bit_tag_t mac_tag;
+  std::copy(&c[ranges.p_begin - SGX_AESGCM_MAC_SIZE], &c[ranges.p_begin], mac_tag);
 
-  return std::pair<std::vector<uint8_t>, std::vector<uint8_t>>(resultPlaintext, resultAad);
+  //Decrypt (in place), the aad for GCM is everything in front of the mac
+  auto status = sgx_rijndael128GCM_decrypt(&sk_enc,
+                                           c.data() + ranges.p_begin, ranges.p_len,
+                                           c.data() + ranges.p_begin,
+                                           &c[sizeof(uint32_t) + sizeof(uint32_t)], SGX_AESGCM_IV_SIZE,
+                                           c.data(), ranges.aad_begin + ranges.aad_len,
+                                           &mac_tag);
+  return status == SGX_SUCCESS;
 }
 
 std::array<uint8_t, SGX_AESGCM_KEY_SIZE> cryptlib::keygen() {
   std::array<uint8_t, SGX_AESGCM_KEY_SIZE> result;
   auto res = sgx_read_rand(result.data(), SGX_AESGCM_KEY_SIZE);
-  assert(res == SGX_SUCCESS);
+  ABORT_UNLESS(res == SGX_SUCCESS); // never hand out a predictable key
   return result;
 }
 
@@ -99,7 +133,7 @@ std::array<uint8_t, SGX_AESGCM_KEY_SIZE> cryptlib::keygen() {
 std::array<uint8_t, SGX_AESGCM_KEY_SIZE> cryptlib::gen_routing_key() {
   std::array<uint8_t, SGX_CMAC_KEY_SIZE> result;
   auto res = sgx_read_rand(result.data(), SGX_CMAC_KEY_SIZE);
-  assert(res == SGX_SUCCESS);
+  ABORT_UNLESS(res == SGX_SUCCESS);
   return result;
 }
 
@@ -114,7 +148,7 @@ onid_t cryptlib::get_intermediate_target(const sgx_cmac_128bit_key_t &sk_routing
   //Evaluate PRF
   sgx_cmac_128bit_tag_t image;
   auto status = sgx_rijndael128_cmac_msg(&sk_routing, preimage.data(), preimage.size(), &image);
-  assert(status == SGX_SUCCESS);
+  ABORT_UNLESS(status == SGX_SUCCESS);
 
   //Interpret PRF image as overlay node id
   onid_t result = (image[3] << 24) | (image[2] << 16) | (image[1] << 8) | (image[0]);
@@ -12,8 +12,46 @@ std::vector<uint8_t> encrypt(const sgx_aes_gcm_128bit_key_t &sk_enc,
                              const std::vector<uint8_t> &p,
                              const std::vector<uint8_t> &aad);
 
-std::pair<std::vector<uint8_t>, std::vector<uint8_t>> decrypt(const sgx_aes_gcm_128bit_key_t &sk_enc,
-                                                              const std::vector<uint8_t> &c);
+/**
+ * Decrypts a ciphertext created by encrypt() (see decrypt_in_place()).
+ * @param sk_enc
+ * @param c
+ * @param p set to the plaintext
+ * @param aad set to the aad
+ * @return false if c is malformed or could not be authenticated (p and aad are not set then)
+ */
+bool decrypt(const sgx_aes_gcm_128bit_key_t &sk_enc,
+             const std::vector<uint8_t> &c,
+             std::vector<uint8_t> &p,
+             std::vector<uint8_t> &aad);
+
+/**
+ * Position of the (encrypted or decrypted) payload and the aad within a ciphertext created by encrypt().
+ */
+struct CiphertextRanges {
+  size_t p_begin;
+  size_t p_len;
+  size_t aad_begin;
+  size_t aad_len;
+};
+
+/**
+ * Determines the ranges of a ciphertext created by encrypt() from its (unauthenticated) length fields.
+ * @param c
+ * @param len length of c
+ * @param ranges
+ * @return false if the length fields do not match len
+ */
+bool get_ranges(const uint8_t *c, size_t len, CiphertextRanges &ranges);
+
+/**
+ * Decrypts a ciphertext created by encrypt() without copying it: the plaintext overwrites the ciphertext within c.
+ * @param sk_enc
+ * @param c the ciphertext (contains the plaintext afterwards)
+ * @param ranges set to the position of plaintext and aad within c
+ * @return false if c is malformed or could not be authenticated (c must not be used then)
+ */
+bool decrypt_in_place(const sgx_aes_gcm_128bit_key_t &sk_enc, std::vector<uint8_t> &c, CiphertextRanges &ranges);
 
 // key generation for sk_pseud or sk_end
 std::array<uint8_t, SGX_AESGCM_KEY_SIZE> keygen();
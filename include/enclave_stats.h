@@ -0,0 +1,101 @@
+// This file contains the counters the client enclave exposes to the untrusted part (included by the EDL, thus C).
+
+#ifndef NETWORK_SGX_EXAMPLE_ENCLAVE_STATS_H
+#define NETWORK_SGX_EXAMPLE_ENCLAVE_STATS_H
+
+#include <stdint.h>
+
+/**
+ * Counters of the messages passed to traffic_in (since the enclave has been initialized).
+ */
+typedef struct traffic_in_stats_t {
+  uint64_t received_messages;
+  uint64_t received_bytes;
+  uint64_t accepted_messages;
+  /** length fields or aad could not be parsed */
+  uint64_t rejected_malformed;
+  /** addressed to another peer */
+  uint64_t rejected_misaddressed;
+  /** for a round that is already over */
+  uint64_t rejected_stale;
+  /** for a round too far in the future */
+  uint64_t rejected_early;
+  /** a message from the same sender has already been received for that round */
+  uint64_t rejected_replayed;
+  /** decryption (i.e., authentication) failed */
+  uint64_t rejected_unauthenticated;
+  /** size of all rejected messages */
+  uint64_t rejected_bytes;
+  /** size of the messages rejected before decryption (and deserialization), i.e., the work saved */
+  uint64_t rejected_bytes_undecrypted;
+} traffic_in_stats_t;
+
+/**
+ * The phases of traffic_out, in the order they run.
+ */
+typedef enum traffic_out_phase_t {
+  /** overlay structure scheme update */
+  TRAFFIC_OUT_PHASE_OVERLAY = 0,
+  /** announce of the own outgoing messages */
+  TRAFFIC_OUT_PHASE_ANNOUNCE,
+  /** start and update of the agreement runs */
+  TRAFFIC_OUT_PHASE_AGREEMENT_UPDATE,
+  /** finalize of the agreement runs */
+  TRAFFIC_OUT_PHASE_AGREEMENT_FINALIZE,
+  /** majority vote over the inject messages */
+  TRAFFIC_OUT_PHASE_INJECT,
+  /** majority vote over the routing messages and route() */
+  TRAFFIC_OUT_PHASE_ROUTING,
+  /** predelivery and delivery */
+  TRAFFIC_OUT_PHASE_DELIVERY,
+  /** padding of the out sets */
+  TRAFFIC_OUT_PHASE_PADDING,
+  /** serialization and encryption of the payloads */
+  TRAFFIC_OUT_PHASE_SEALING,
+  /** the next round's inbox becomes the current one */
+  TRAFFIC_OUT_PHASE_INBOX_ROTATION,
+  /** passing the ciphertexts to the untrusted part */
+  TRAFFIC_OUT_PHASE_OUTPUT,
+  TRAFFIC_OUT_NUM_PHASES
+} traffic_out_phase_t;
+
+/**
+ * Timers of (one or more) calls of traffic_out.
+ * Only timings are exported: counts of elements or dummies would tell the untrusted part how much of the (padded)
+ * traffic is real.
+ */
+typedef struct traffic_out_round_stats_t {
+  /** number of calls of traffic_out accounted */
+  uint64_t rounds;
+  /** nanoseconds spent in each phase (clock of the untrusted part, thus not trustworthy, but only reported) */
+  uint64_t phase_ns[TRAFFIC_OUT_NUM_PHASES];
+} traffic_out_round_stats_t;
+
+/**
+ * Counters of the round arena of traffic_out. They depend on the number of real elements, so they are only filled in
+ * by enclaves built without NDEBUG (and are 0 otherwise).
+ */
+typedef struct traffic_out_arena_stats_t {
+  /** allocations served by the arena in the last call of traffic_out */
+  uint64_t last_round_allocations;
+  /** maximal number of bytes handed out in any call of traffic_out */
+  uint64_t peak_bytes;
+  /** number of blocks the arena has obtained from the heap (grows only while the rounds get bigger) */
+  uint64_t heap_blocks;
+} traffic_out_arena_stats_t;
+
+/**
+ * The traffic_out timers exported by ecall_get_traffic_out_stats (since the enclave has been initialized).
+ */
+typedef struct traffic_out_stats_t {
+  /** the round of the last call of traffic_out */
+  uint64_t last_round_number;
+  traffic_out_round_stats_t last_round;
+  /** the call of traffic_out that took longest (in total) */
+  traffic_out_round_stats_t slowest_round;
+  /** the sum over all calls */
+  traffic_out_round_stats_t total;
+  traffic_out_arena_stats_t arena;
+} traffic_out_stats_t;
+
+#endif //NETWORK_SGX_EXAMPLE_ENCLAVE_STATS_H
@@ -81,6 +81,32 @@ std::vector<T> deserialize_vec(const std::vector<uint8_t> &working_vec, size_t &
   return result;
 }
 
+/**
+ * Deserialize a vector of Serializable objects element by element, handing each element to consume instead of
+ * collecting them in a vector.
+ * @tparam T type of the objects in the vector
+ * @param working_vec vector holding the serialized data
+ * @param cur index of the first byte of the serialized vector in working_vec
+ * @param consume called with every deserialized element (as rvalue)
+ * @param skip called before each element: if it returns true, it has advanced cur past the element, which is then
+ * not deserialized at all
+ */
+template<typename T, typename Consume, typename Skip,
+    typename std::enable_if<std::is_base_of<Serializable, T>::value>::type * = nullptr>
+void deserialize_vec_each(const std::vector<uint8_t> &working_vec, size_t &cur, Consume consume, Skip skip) {
+  auto size = deserialize_number<typename std::vector<T>::size_type>(working_vec, cur);
+  for (size_t i = 0; i < size; ++i) {
+    if (!skip(working_vec, cur)) {
+      consume(T::deserialize(working_vec, cur));
+    }
+  }
+}
+
+template<typename T, typename Consume, typename std::enable_if<std::is_base_of<Serializable, T>::value>::type * = nullptr>
+void deserialize_vec_each(const std::vector<uint8_t> &working_vec, size_t &cur, Consume consume) {
+  deserialize_vec_each<T>(working_vec, cur, consume, [](const std::vector<uint8_t> &, size_t &) { return false; });
+}
+
 template<typename T>
 T deserialize_number_from_pointer(const std::vector<uint8_t> *working_vec, size_t &cur) {
   // result.length_ = ((working_vec[cur++]<<24)|(working_vec[cur++]<<16)|(working_vec[cur++]<<8)|(working_vec[cur++]));
@@ -12,7 +12,7 @@ namespace c1 {
  * @param dimension the dimension of the overlay network
  * @param func the function to be called on onid' where onid' is a neighbor of node_id in the overlay network
  */
-void for_all_neighbors(onid_t node_id, int dimension, std::function<void(uint64_t)> func) {
+inline void for_all_neighbors(onid_t node_id, int dimension, std::function<void(uint64_t)> func) {
   func(node_id);
   for (int i = 0; i < dimension; ++i) {
     uint64_t node_id_i_th_bit_flipped = node_id ^1UL << i;
@@ -11,17 +11,22 @@
 #include <cassert>
 #include <sgx_tcrypto.h>
 #include <array>
+#include <functional>
 #include "serialization.h"
 #include "config.h"
 
 namespace c1 {
 
-enum MsgTypes { kTypeJoinMessage, kTypeInitMessage };
+enum MsgTypes {
+  kTypeJoinMessage, kTypeInitMessage, kTypeShardJoinsMessage, kTypeShardPlanMessage, kTypeShardHelloMessage
+};
 
 /**
  * An URI consisting of an IPv4 address (to be accessed byte-wise via ip1, ..., ip4) and a port number.
  */
 struct Uri : Serializable {
+  static constexpr size_t kSerializedSize = 4 * sizeof(uint8_t) + sizeof(uint64_t);
+
   uint8_t ip1;
   uint8_t ip2;
   uint8_t ip3;
@@ -72,6 +77,34 @@ struct Uri : Serializable {
     return result;
   }
 
+  /**
+   * Parses an uri of the form ip1.ip2.ip3.ip4:port (as created by the conversion to std::string).
+   * @return false if str is not of that form (uri is undefined then)
+   */
+  static bool parse(const std::string &str, Uri &uri) {
+    uint64_t parts[5];
+    size_t cur = 0;
+    for (int part = 0; part < 5; ++part) {
+      if (part > 0) {
+        if (cur == str.size() || str[cur] != (part == 4 ? ':' : '.')) {
+          return false;
+        }
+        cur++;
+      }
+      auto begin = cur;
+      parts[part] = 0;
+      while (cur < str.size() && str[cur] >= '0' && str[cur] <= '9' && cur - begin < 5) {
+        parts[part] = 10 * parts[part] + (str[cur] - '0');
+        cur++;
+      }
+      if (cur == begin || parts[part] > (part == 4 ? 65535 : 255)) {
+        return false;
+      }
+    }
+    uri = Uri(parts[0], parts[1], parts[2], parts[3], parts[4]);
+    return cur == str.size();
+  }
+
   inline operator std::string const() const {
     std::string result = "";
     result += std::to_string(ip1) + "." + std::to_string(ip2) + "." + std::to_string(ip3) + "." + std::to_string(ip4);
@@ -81,10 +114,22 @@ struct Uri : Serializable {
 
 };
 
+/**
+ * Hash function for Uri, so that peers can be indexed by the uri of their socket.
+ */
+struct UriHash {
+  size_t operator()(const Uri &uri) const {
+    uint64_t ip = (uint64_t{uri.ip1} << 24) | (uint64_t{uri.ip2} << 16) | (uint64_t{uri.ip3} << 8) | uri.ip4;
+    return std::hash<uint64_t>()((ip << 32) ^ uri.port);
+  }
+};
+
 /**
  * Basic structure holding the id of a peer and the uri of its socket.
  */
 struct PeerInformation : public Serializable {
+  static constexpr size_t kSerializedSize = sizeof(uint64_t) + Uri::kSerializedSize;
+
   uint64_t id;
   Uri uri;
 
@@ -110,6 +155,34 @@ struct PeerInformation : public Serializable {
     return result;
   }
 
+  /**
+   * Parses an uri of the form ip1.ip2.ip3.ip4:port (as created by the conversion to std::string).
+   * @return false if str is not of that form (uri is undefined then)
+   */
+  static bool parse(const std::string &str, Uri &uri) {
+    uint64_t parts[5];
+    size_t cur = 0;
+    for (int part = 0; part < 5; ++part) {
+      if (part > 0) {
+        if (cur == str.size() || str[cur] != (part == 4 ? ':' : '.')) {
+          return false;
+        }
+        cur++;
+      }
+      auto begin = cur;
+      parts[part] = 0;
+      while (cur < str.size() && str[cur] >= '0' && str[cur] <= '9' && cur - begin < 5) {
+        parts[part] = 10 * parts[part] + (str[cur] - '0');
+        cur++;
+      }
+      if (cur == begin || parts[part] > (part == 4 ? 65535 : 255)) {
+        return false;
+      }
+    }
+    uri = Uri(parts[0], parts[1], parts[2], parts[3], parts[4]);
+    return cur == str.size();
+  }
+
   inline operator std::string const() const {
     std::string result = "";
     result += "Id: " + std::to_string(id) + ", ";
@@ -193,7 +266,7 @@ size_t size_of_map_keys(const typename std::map<T, U> &map) {
  * @return memory location after the contents
  */
 template<typename T>
-char *copy_vector(char *ptr, std::vector<T> &vec) {
+char *copy_vector(char *ptr, const std::vector<T> &vec) {
   std::copy(vec.begin(), vec.end(), reinterpret_cast<T *>(ptr));
   return ptr + size_of_vec(vec);
 };
@@ -207,6 +280,13 @@ const char *obtain_vector(const char *ptr, size_t size, std::vector<T> &vec) {
 
 /**
  * InitMessage sent from the login server to the peers to supply them with the init data.
+ *
+ * Serialized format (version kVersion, integers in host byte order):
+ *   InitMessageLowLevelHeader | sk_pseud | sk_enc | sk_routing
+ *   | directory: directory_size entries of kDirectoryEntrySize bytes (id, ip1, ..., ip4, port)
+ *   | gamma_send: indices (uint32_t) into the directory | gamma_receive: indices
+ *   | gamma_route: per entry the onid (uint64_t), the number of peers (uint32_t) and their indices
+ * Every peer is thus sent once, no matter in how many of the sets it occurs.
  */
 class InitMessage {
   uint64_t receiver_id_;
@@ -226,7 +306,13 @@ class InitMessage {
   sgx_aes_gcm_128bit_key_t sk_enc_sgx_;
   sgx_cmac_128bit_key_t sk_routing_sgx_;
 
+  /** whether the message has been parsed successfully (always true for messages not created from a buffer) */
+  bool valid_ = true;
+
  public:
+  /** version of the serialized format */
+  static constexpr uint32_t kVersion = 2;
+
   uint64_t get_receiver_id_() const {
     return receiver_id_;
   }
@@ -270,6 +356,11 @@ class InitMessage {
     return sk_routing_sgx_;
   }
 
+  /** false if the buffer the message has been created from is malformed (the other fields must not be used then) */
+  bool is_valid() const {
+    return valid_;
+  }
+
   InitMessage(uint64_t receiver_id_,
               uint64_t num_total_nodes_,
               uint64_t num_quorum_nodes_,
@@ -292,15 +383,23 @@ class InitMessage {
 
   struct InitMessageLowLevelHeader {
     uint64_t msg_type;
+    uint32_t version;
+    uint32_t directory_size;
     uint64_t receiver_id_;
     uint64_t num_total_nodes_;
     uint64_t overlay_dimension_;
     uint64_t onid_assoc;
     uint64_t onid_emul;
-    size_t gamma_send_entry_count;
-    size_t gamma_receive_entry_count;
-    size_t gamma_route_entry_count;
+    uint32_t gamma_send_entry_count;
+    uint32_t gamma_receive_entry_count;
+    uint32_t gamma_route_entry_count;
+    /** the number of indices of all gamma_route entries together */
+    uint32_t gamma_route_index_count;
   };
+  static_assert(sizeof(InitMessageLowLevelHeader) == 72, "the header must not contain padding");
+
+  static constexpr size_t kDirectoryEntrySize = sizeof(uint64_t) + 4 * sizeof(uint8_t) + sizeof(uint64_t);
+  static constexpr size_t kKeysSize = 2 * SGX_AESGCM_KEY_SIZE + SGX_CMAC_KEY_SIZE;
 
   void copy_crypto_keys() {
     memcpy(sk_pseud_sgx_, sk_pseud_.data(), sk_pseud_.size());
@@ -308,22 +407,74 @@ class InitMessage {
     memcpy(sk_routing_sgx_, sk_routing_.data(), sk_routing_.size());
   }
 
- public:
   /**
-   * Serialization constructor.
-   * @param ptr pointer to the serialized object
+   * Reads values of fixed size from a buffer, failing (instead of reading past its end) if it is too short.
    */
-  InitMessage(const char *ptr) {
+  class BoundedReader {
+    const char *ptr_;
+    const char *end_;
+
+   public:
+    BoundedReader(const char *ptr, size_t len) : ptr_(ptr), end_(ptr + len) {}
+
+    bool read(void *dst, size_t len) {
+      if (static_cast<size_t>(end_ - ptr_) < len) {
+        return false;
+      }
+      memcpy(dst, ptr_, len);
+      ptr_ += len;
+      return true;
+    }
+
+    template<typename T>
+    bool read(T &value) {
+      return read(&value, sizeof(T));
+    }
+
+    bool at_end() const {
+      return ptr_ == end_;
+    }
+  };
+
+  /**
+   * Reads count indices from reader and appends the corresponding peers of the directory to peers.
+   * @return false if the message is malformed
+   */
+  static bool read_peers(BoundedReader &reader,
+                         size_t count,
+                         const std::vector<PeerInformation> &directory,
+                         std::vector<PeerInformation> &peers) {
+    peers.reserve(peers.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+      uint32_t index;
+      if (!reader.read(index) || index >= directory.size()) {
+        return false;
+      }
+      peers.push_back(directory[index]);
+    }
+    return true;
+  }
+
+  bool parse(const char *ptr, size_t len) {
+    BoundedReader reader(ptr, len);
     InitMessageLowLevelHeader low_level_header;
-    memcpy(&low_level_header, ptr, sizeof(low_level_header));
-    ptr += sizeof(low_level_header);
-
-    memcpy(sk_pseud_.data(), ptr, SGX_AESGCM_KEY_SIZE);
-    ptr += SGX_AESGCM_KEY_SIZE;
-    memcpy(sk_enc_.data(), ptr, SGX_AESGCM_KEY_SIZE);
-    ptr += SGX_AESGCM_KEY_SIZE;
-    memcpy(sk_routing_.data(), ptr, SGX_CMAC_KEY_SIZE);
-    ptr += SGX_CMAC_KEY_SIZE;
+    if (!reader.read(low_level_header) || low_level_header.msg_type != kTypeInitMessage
+        || low_level_header.version != kVersion) {
+      return false;
+    }
+    // the size is determined by the header, so it is checked before anything is allocated
+    uint64_t expected_len = sizeof(low_level_header) + kKeysSize
+        + uint64_t{low_level_header.directory_size} * kDirectoryEntrySize
+        + (uint64_t{low_level_header.gamma_send_entry_count} + low_level_header.gamma_receive_entry_count) * 4
+        + uint64_t{low_level_header.gamma_route_entry_count} * (sizeof(uint64_t) + sizeof(uint32_t))
+        + uint64_t{low_level_header.gamma_route_index_count} * sizeof(uint32_t);
+    if (expected_len != len) {
+      return false;
+    }
+
+    reader.read(sk_pseud_.data(), SGX_AESGCM_KEY_SIZE);
+    reader.read(sk_enc_.data(), SGX_AESGCM_KEY_SIZE);
+    reader.read(sk_routing_.data(), SGX_CMAC_KEY_SIZE);
     copy_crypto_keys();
 
     receiver_id_ = low_level_header.receiver_id_;
@@ -332,85 +483,254 @@ class InitMessage {
     onid_assoc_ = low_level_header.onid_assoc;
     onid_emul_ = low_level_header.onid_emul;
 
-    //obtain gamma_send
-    ptr = obtain_vector(ptr, low_level_header.gamma_send_entry_count, gamma_send_);
-    ptr = obtain_vector(ptr, low_level_header.gamma_receive_entry_count, gamma_receive_);
-    for (int i = 0; i < low_level_header.gamma_route_entry_count; ++i) {
-      uint64_t key = *reinterpret_cast<const uint64_t *>(ptr);
-      gamma_route_[key] = std::vector<PeerInformation>();
-      ptr += sizeof(uint64_t); // this might be improved by using a different pointer type
-
-      size_t num_entries = *reinterpret_cast<const size_t *>(ptr);
-      ptr += sizeof(size_t);
-      ptr = obtain_vector(ptr, num_entries, gamma_route_[key]);
+    std::vector<PeerInformation> directory(low_level_header.directory_size);
+    for (auto &peer : directory) {
+      reader.read(peer.id);
+      reader.read(peer.uri.ip1);
+      reader.read(peer.uri.ip2);
+      reader.read(peer.uri.ip3);
+      reader.read(peer.uri.ip4);
+      reader.read(peer.uri.port);
+    }
+
+    if (!read_peers(reader, low_level_header.gamma_send_entry_count, directory, gamma_send_)
+        || !read_peers(reader, low_level_header.gamma_receive_entry_count, directory, gamma_receive_)) {
+      return false;
     }
+    uint64_t num_route_indices = 0;
+    for (uint32_t i = 0; i < low_level_header.gamma_route_entry_count; ++i) {
+      uint64_t key;
+      uint32_t num_entries;
+      if (!reader.read(key) || !reader.read(num_entries)) {
+        return false;
+      }
+      num_route_indices += num_entries;
+      if (num_route_indices > low_level_header.gamma_route_index_count
+          || !read_peers(reader, num_entries, directory, gamma_route_[key])) {
+        return false;
+      }
+    }
+    return reader.at_end();
+  }
+
+  static void append(std::vector<char> &out, const void *ptr, size_t len) {
+    out.insert(out.end(), static_cast<const char *>(ptr), static_cast<const char *>(ptr) + len);
+  }
 
+  template<typename T>
+  static void append(std::vector<char> &out, const T &value) {
+    append(out, &value, sizeof(T));
+  }
+
+ public:
+  /**
+   * Serialization constructor.
+   * @param ptr pointer to the serialized object
+   * @param len its length (nothing beyond is read, see is_valid())
+   */
+  InitMessage(const char *ptr, size_t len) {
+    valid_ = parse(ptr, len);
   }
 
   /**
    * serializes the object in memory
    * @return pointer to the serialized object and the size of it
    */
-  std::pair<std::shared_ptr<char>, int> serialize() {
-    //compute required memory space:
-    int size = sizeof(InitMessageLowLevelHeader);
-    size += SGX_AESGCM_KEY_SIZE * 2;
-    size += SGX_CMAC_KEY_SIZE;
-    size += size_of_vec(gamma_send_);
-    size += size_of_vec(gamma_receive_);
-    size += size_of_map_keys(gamma_route_);
-    int gamma_route_entries_size = 0;
-    for (auto vec: gamma_route_) {
-      gamma_route_entries_size +=
-          sizeof(size_t) + size_of_vec(vec.second); // used to store the entry counts and the vectors
+  std::pair<std::shared_ptr<char>, int> serialize() const {
+    std::vector<char> serialized;
+    serialize_to(serialized, receiver_id_, num_total_nodes_, overlay_dimension_, onid_assoc_, onid_emul_,
+                 gamma_send_, gamma_receive_, gamma_route_, sk_pseud_, sk_enc_, sk_routing_);
+    std::shared_ptr<char> serialized_object(new char[serialized.size()], std::default_delete<char[]>());
+    std::copy(serialized.begin(), serialized.end(), serialized_object.get());
+    return std::pair<std::shared_ptr<char>, int>{serialized_object, serialized.size()};
+  }
+
+  /**
+   * Serializes an init message straight from the given sets, which can thus be shared between the init messages of
+   * many peers (no InitMessage has to be created).
+   * @param out the message is appended to out
+   */
+  static void serialize_to(std::vector<char> &out,
+                           uint64_t receiver_id,
+                           uint64_t num_total_nodes,
+                           uint64_t overlay_dimension,
+                           uint64_t onid_assoc,
+                           uint64_t onid_emul,
+                           const std::vector<PeerInformation> &gamma_send,
+                           const std::vector<PeerInformation> &gamma_receive,
+                           const std::map<uint64_t, std::vector<PeerInformation>> &gamma_route,
+                           const std::array<uint8_t, SGX_AESGCM_KEY_SIZE> &sk_pseud,
+                           const std::array<uint8_t, SGX_AESGCM_KEY_SIZE> &sk_enc,
+                           const std::array<uint8_t, SGX_CMAC_KEY_SIZE> &sk_routing) {
+    // the directory contains every peer once, the sets refer to it by index
+    std::vector<const PeerInformation *> directory;
+    std::map<uint64_t, uint32_t> index_for_id;
+    std::vector<uint32_t> indices;
+    auto add_indices = [&](const std::vector<PeerInformation> &peers) {
+      for (const auto &peer : peers) {
+        auto[it, inserted] = index_for_id.emplace(peer.id, static_cast<uint32_t>(directory.size()));
+        if (inserted) {
+          directory.push_back(&peer);
+        }
+        indices.push_back(it->second);
+      }
+    };
+    add_indices(gamma_send);
+    add_indices(gamma_receive);
+    uint32_t gamma_route_index_count = 0;
+    for (const auto &[onid, peers] : gamma_route) {
+      add_indices(peers);
+      gamma_route_index_count += peers.size();
     }
-    size += gamma_route_entries_size;
 
     // initialize the low level header and insert the right values:
     InitMessageLowLevelHeader low_level_header;
     low_level_header.msg_type = kTypeInitMessage;
-    low_level_header.receiver_id_ = receiver_id_;
-    low_level_header.num_total_nodes_ = num_total_nodes_;
-    low_level_header.overlay_dimension_ = overlay_dimension_;
-    low_level_header.onid_assoc = onid_assoc_;
-    low_level_header.onid_emul = onid_emul_;
-    low_level_header.gamma_send_entry_count = gamma_send_.size();
-    low_level_header.gamma_receive_entry_count = gamma_receive_.size();
-    low_level_header.gamma_route_entry_count = gamma_route_.size();
-
-    //auto serialized_object = new char[size];
-    std::shared_ptr<char> serialized_object(new char[size], std::default_delete<char[]>());
-    auto myptr = serialized_object.get();
-    // store low_level_header
-    memcpy(myptr, &low_level_header, sizeof(low_level_header));
-    myptr += sizeof(low_level_header);
+    low_level_header.version = kVersion;
+    low_level_header.directory_size = directory.size();
+    low_level_header.receiver_id_ = receiver_id;
+    low_level_header.num_total_nodes_ = num_total_nodes;
+    low_level_header.overlay_dimension_ = overlay_dimension;
+    low_level_header.onid_assoc = onid_assoc;
+    low_level_header.onid_emul = onid_emul;
+    low_level_header.gamma_send_entry_count = gamma_send.size();
+    low_level_header.gamma_receive_entry_count = gamma_receive.size();
+    low_level_header.gamma_route_entry_count = gamma_route.size();
+    low_level_header.gamma_route_index_count = gamma_route_index_count;
+
+    out.reserve(out.size() + sizeof(low_level_header) + kKeysSize + directory.size() * kDirectoryEntrySize
+                    + indices.size() * sizeof(uint32_t) + gamma_route.size() * (sizeof(uint64_t) + sizeof(uint32_t)));
+    append(out, low_level_header);
     // store crypto keys
-    memcpy(myptr, &sk_pseud_, SGX_AESGCM_KEY_SIZE);
-    myptr += SGX_AESGCM_KEY_SIZE;
-    memcpy(myptr, &sk_enc_, SGX_AESGCM_KEY_SIZE);
-    myptr += SGX_AESGCM_KEY_SIZE;
-    memcpy(myptr, &sk_routing_, SGX_CMAC_KEY_SIZE);
-    myptr += SGX_CMAC_KEY_SIZE;
-    // store gamma_send
-    myptr = copy_vector(myptr, gamma_send_);
-    // store gamma_receive
-    myptr = copy_vector(myptr, gamma_receive_);
-    // store gamma_route keys:
-    auto myptr2 = myptr;
-    for (auto elem : gamma_route_) {
-      //for(auto myptr2 = myptr; myptr2 < myptr + size_of_map_keys(gamma_route_); ) {
-      *reinterpret_cast<uint64_t *>(myptr2) = elem.first;
-      myptr2 += sizeof(uint64_t);
-      *reinterpret_cast<size_t *>(myptr2) = elem.second.size();
-      myptr2 += sizeof(size_t);
-      myptr2 = copy_vector(myptr2, elem.second);
-
+    append(out, sk_pseud.data(), SGX_AESGCM_KEY_SIZE);
+    append(out, sk_enc.data(), SGX_AESGCM_KEY_SIZE);
+    append(out, sk_routing.data(), SGX_CMAC_KEY_SIZE);
+    // store the directory
+    for (const auto *peer : directory) {
+      append(out, peer->id);
+      append(out, peer->uri.ip1);
+      append(out, peer->uri.ip2);
+      append(out, peer->uri.ip3);
+      append(out, peer->uri.ip4);
+      append(out, peer->uri.port);
     }
-    assert(myptr2 = myptr + size_of_map_keys(gamma_route_) + gamma_route_entries_size);
+    // store gamma_send and gamma_receive (by offset into indices: any of the sets may be empty)
+    size_t offset = gamma_send.size() + gamma_receive.size();
+    append(out, indices.data(), offset * sizeof(uint32_t));
+    // store gamma_route
+    for (const auto &[onid, peers] : gamma_route) {
+      append(out, onid);
+      append(out, static_cast<uint32_t>(peers.size()));
+      append(out, indices.data() + offset, peers.size() * sizeof(uint32_t));
+      offset += peers.size();
+    }
+  }
+
+};
+
+/**
+ * Precedes each init message within a batch passed from the login server's enclave to its untrusted part. It is
+ * followed by the uri of the receiver (uri_len chars) and the message itself (msg_len bytes).
+ */
+struct BootstrapBatchRecordHeader {
+  uint64_t uri_len;
+  uint64_t msg_len;
+};
+
+/**
+ * Precedes each message within a batch of client messages passed from the login server's untrusted part to its
+ * enclave. It is followed by the message itself (msg_len bytes).
+ */
+struct ClientMessageBatchRecordHeader {
+  uint64_t msg_len;
+};
 
-    return std::pair<std::shared_ptr<char>, int>{serialized_object, size};
+/**
+ * A client within the messages between the shards of a sharded login server (fixed layout, host byte order).
+ */
+struct ShardClientRecord {
+  uint64_t id;
+  uint64_t port;
+  uint8_t ip1;
+  uint8_t ip2;
+  uint8_t ip3;
+  uint8_t ip4;
+  /** the shard the client has joined at */
+  uint32_t shard;
+  /** only set in ShardPlanMessages */
+  uint64_t associated_quorum;
+  /** only set in ShardPlanMessages */
+  uint64_t emulated_quorum;
+
+  ShardClientRecord() = default;
+
+  ShardClientRecord(const PeerInformation &peer, uint32_t shard, uint64_t associated_quorum, uint64_t emulated_quorum)
+      : id(peer.id), port(peer.uri.port), ip1(peer.uri.ip1), ip2(peer.uri.ip2), ip3(peer.uri.ip3), ip4(peer.uri.ip4),
+        shard(shard), associated_quorum(associated_quorum), emulated_quorum(emulated_quorum) {}
+
+  PeerInformation peer() const {
+    return PeerInformation(id, Uri(ip1, ip2, ip3, ip4, port));
   }
+};
+static_assert(sizeof(ShardClientRecord) == 40, "ShardClientRecord must not contain padding");
+
+/**
+ * Sent from a follower shard of the login server to the leader (shard 0): the clients that joined at the follower
+ * since its last ShardJoinsMessage. Followed by num_clients ShardClientRecords.
+ */
+struct ShardJoinsMessageHeader {
+  uint64_t msg_type = kTypeShardJoinsMessage;
+  uint64_t num_clients;
+};
+
+/**
+ * Sent from the leader of a sharded login server to each follower once all clients have joined: everything the
+ * followers need to build the init messages of their clients. Followed by num_clients ShardClientRecords (ordered by
+ * id, each with its quorums).
+ */
+struct ShardPlanMessageHeader {
+  uint64_t msg_type = kTypeShardPlanMessage;
+  uint64_t num_clients;
+  uint64_t dimension;
+  uint8_t sk_pseud[SGX_AESGCM_KEY_SIZE];
+  uint8_t sk_enc[SGX_AESGCM_KEY_SIZE];
+  uint8_t sk_routing[SGX_CMAC_KEY_SIZE];
+};
+
+/**
+ * Sent from a follower shard of the login server to the leader once it has started, and answered by the leader: opens
+ * the sessions the other messages between the two shards are bound to (see ShardMessageAad). No further content.
+ */
+struct ShardHelloMessage {
+  uint64_t msg_type = kTypeShardHelloMessage;
+};
+
+/**
+ * The authenticated (but not encrypted) data of each message between the shards of a sharded login server. The
+ * sessions are random numbers each shard draws at start, so that messages of earlier runs are rejected, the sequence
+ * number rejects messages that are replayed within a run.
+ */
+struct ShardMessageAad {
+  uint32_t from_shard;
+  uint32_t to_shard;
+  uint64_t sender_session;
+  /** 0 in the hello of a follower (the session of the leader is not known yet) */
+  uint64_t receiver_session;
+  /** increases with each message from from_shard to to_shard (starting at 1) */
+  uint64_t seq;
+};
+static_assert(sizeof(ShardMessageAad) == 32, "ShardMessageAad must not contain padding");
 
+/**
+ * The first byte of each command sent to the user socket of a client.
+ */
+enum UserInterfaceCommandType : char {
+  /** no further content */
+  kUserCommandGeneratePseudonym = 0,
+  /** followed by one UserInterfaceMessageInjectionCommand */
+  kUserCommandSendMessage = 1,
+  /** followed by any number of UserInterfaceMessageInjectionCommands (sent by one ecall) */
+  kUserCommandSendMessages = 2
 };
 
 /**
@@ -423,6 +743,28 @@ struct UserInterfaceMessageInjectionCommand {
   uint64_t t_dst;
 };
 
+/**
+ * Published to the peer interface for every message received (the topic of the message is the destination pseudonym).
+ */
+struct UserInterfaceReceivedMessage {
+  uint8_t n_src[kPseudonymSize];
+  uint8_t msg[kMessageSize];
+  uint64_t t_dst;
+};
+
+/** topic of the UserInterfaceGeneratedPseudonym publications (shorter than a pseudonym, so it never matches one) */
+constexpr char kTopicGeneratedPseudonym[] = "generated_pseudonym";
+
+/**
+ * Published to the peer interface for every pseudonym generated on its request (under the topic
+ * kTopicGeneratedPseudonym), so that it can be used without reading the output of the client.
+ */
+struct UserInterfaceGeneratedPseudonym {
+  uint8_t pseudonym[kPseudonymSize];
+  /** the time of the client (the time t_dst refers to) when the pseudonym has been generated */
+  uint64_t time;
+};
+
 }
 
 #endif //NETWORK_SGX_EXAMPLE_SHARED_STRUCTS_H
@@ -0,0 +1,378 @@
+#include <zmq.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <algorithm>
+#include "../include/shared_structs.h"
+
+/*
+ * Load generator for a running system: creates pseudonyms on the given nodes (clients), injects messages between them
+ * at a target rate and matches the messages published by the destination nodes to measure the end-to-end latency
+ * and the loss.
+ *
+ * Parameters are given as key=value arguments, or as lines "key value" (or key=value, # starts a comment) of a
+ * workload file given by workload=<file>:
+ *   node=<user port>:<publish port>  a client, by the ports it prints at startup (repeat for each client)
+ *   pseudonyms_per_node=1            pseudonyms created on each node
+ *   rate=1                           messages injected per second (over all nodes)
+ *   duration=60                      seconds messages are injected for
+ *   t_dst_offset_min=240             t_dst of a message is the time of its source node plus a uniformly chosen
+ *   t_dst_offset_max=300             offset (seconds), it has to leave room for the agreement and the routing
+ *   drain=60                         seconds to wait for messages after the latest t_dst
+ *   seed=1
+ *
+ * Each pseudonym may send kSend messages per round (of t_dst), messages that would exceed this are not injected but
+ * counted as skipped.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+/** marks the messages of the load generator (the rest of the message is a LoadMessageHeader) */
+constexpr uint64_t kLoadMessageMagic = 0x6c6f616467656e31;
+
+/**
+ * Written to the beginning of each injected message to match it on delivery.
+ */
+struct LoadMessageHeader {
+  uint64_t magic;
+  uint64_t sequence_number;
+};
+
+struct Parameters {
+  std::vector<std::pair<std::string, std::string>> nodes;
+  size_t pseudonyms_per_node = 1;
+  double rate = 1;
+  double duration = 60;
+  uint64_t t_dst_offset_min = 240;
+  uint64_t t_dst_offset_max = 300;
+  double drain = 60;
+  uint64_t seed = 1;
+};
+
+/**
+ * A client the load is generated for.
+ */
+struct Node {
+  zmq::socket_t socket_out;
+  zmq::socket_t socket_in;
+  std::string name;
+};
+
+/**
+ * A pseudonym created by the load generator.
+ */
+struct LoadPseudonym {
+  size_t node;
+  std::array<uint8_t, kPseudonymSize> pseudonym;
+  /** the time of the node when the pseudonym has been generated and when that was (locally) */
+  uint64_t node_time;
+  Clock::time_point generated_at;
+  /** the number of messages sent per round */
+  std::unordered_map<uint64_t, int> num_sent_for_round;
+
+  /** estimates the current time of the node */
+  uint64_t node_time_at(Clock::time_point t) const {
+    return node_time + std::chrono::duration_cast<std::chrono::seconds>(t - generated_at).count();
+  }
+};
+
+/**
+ * An injected message not received yet.
+ */
+struct PendingMessage {
+  Clock::time_point sent_at;
+  /** (local) time at which the message is due at its destination */
+  Clock::time_point due_at;
+};
+
+/**
+ * Sets the parameter key to value.
+ * @return false if key is unknown
+ */
+bool set_parameter(Parameters &parameters, const std::string &key, const std::string &value);
+
+/**
+ * Reads the parameters of a workload file.
+ * @return false if the file cannot be read or contains an unknown parameter
+ */
+bool read_workload_file(Parameters &parameters, const std::string &path) {
+  std::ifstream file(path);
+  if (!file) {
+    std::cerr << "Cannot read workload file " << path << std::endl;
+    return false;
+  }
+  std::string line;
+  while (std::getline(file, line)) {
+    line = line.substr(0, line.find('#'));
+    std::replace(line.begin(), line.end(), '=', ' ');
+    std::istringstream line_stream(line);
+    std::string key, value;
+    if (!(line_stream >> key)) {
+      continue;
+    }
+    line_stream >> value;
+    if (!set_parameter(parameters, key, value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool set_parameter(Parameters &parameters, const std::string &key, const std::string &value) {
+  try {
+    if (key == "node") {
+      auto colon = value.find(':');
+      if (colon == std::string::npos) {
+        std::cerr << "node has to be given as <user port>:<publish port>" << std::endl;
+        return false;
+      }
+      parameters.nodes.emplace_back(value.substr(0, colon), value.substr(colon + 1));
+    } else if (key == "workload") {
+      return read_workload_file(parameters, value);
+    } else if (key == "pseudonyms_per_node") {
+      parameters.pseudonyms_per_node = std::stoul(value);
+    } else if (key == "rate") {
+      parameters.rate = std::stod(value);
+    } else if (key == "duration") {
+      parameters.duration = std::stod(value);
+    } else if (key == "t_dst_offset_min") {
+      parameters.t_dst_offset_min = std::stoull(value);
+    } else if (key == "t_dst_offset_max") {
+      parameters.t_dst_offset_max = std::stoull(value);
+    } else if (key == "drain") {
+      parameters.drain = std::stod(value);
+    } else if (key == "seed") {
+      parameters.seed = std::stoull(value);
+    } else {
+      std::cerr << "Unknown parameter " << key << std::endl;
+      return false;
+    }
+  } catch (std::exception &e) {
+    std::cerr << "Invalid value " << value << " of parameter " << key << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Percentile of sorted values (0 if there are none).
+ */
+double percentile(const std::vector<double> &sorted_values, double p) {
+  if (sorted_values.empty()) {
+    return 0;
+  }
+  auto index = static_cast<size_t>(p * (sorted_values.size() - 1) + 0.5);
+  return sorted_values[std::min(index, sorted_values.size() - 1)];
+}
+
+void print_distribution(const std::string &name, std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  std::cout << name << " [s]: p50 " << percentile(values, 0.5) << ", p90 " << percentile(values, 0.9) << ", p99 "
+            << percentile(values, 0.99) << ", max " << (values.empty() ? 0 : values.back()) << std::endl;
+}
+
+} // ~namespace
+
+int main(int argc, char *argv[]) {
+  using namespace c1;
+
+  Parameters parameters;
+  for (int i = 1; i < argc; ++i) {
+    std::string argument(argv[i]);
+    auto equals = argument.find('=');
+    if (equals == std::string::npos
+        || !set_parameter(parameters, argument.substr(0, equals), argument.substr(equals + 1))) {
+      std::cerr << "usage: " << argv[0] << " node=<user port>:<publish port> ... [workload=<file>] [rate=...] "
+                << "[duration=...] [pseudonyms_per_node=...] [t_dst_offset_min=...] [t_dst_offset_max=...] "
+                << "[drain=...] [seed=...]" << std::endl;
+      return -1;
+    }
+  }
+  if (parameters.nodes.empty() || parameters.rate <= 0
+      || parameters.t_dst_offset_min > parameters.t_dst_offset_max) {
+    std::cerr << "At least one node, a positive rate and t_dst_offset_min <= t_dst_offset_max are required"
+              << std::endl;
+    return -1;
+  }
+
+  zmq::context_t context(1);
+  std::vector<Node> nodes;
+  std::vector<zmq::pollitem_t> pollitems;
+  for (const auto &[user_port, publish_port] : parameters.nodes) {
+    Node node{zmq::socket_t(context, ZMQ_PUSH), zmq::socket_t(context, ZMQ_SUB), user_port};
+    node.socket_out.setsockopt(ZMQ_LINGER, 0);
+    node.socket_out.connect("tcp://localhost:" + user_port);
+    node.socket_in.setsockopt(ZMQ_LINGER, 0);
+    node.socket_in.connect("tcp://localhost:" + publish_port);
+    node.socket_in.setsockopt(ZMQ_SUBSCRIBE, "", 0); // generated pseudonyms and all received messages
+    nodes.push_back(std::move(node));
+  }
+  for (auto &node : nodes) {
+    pollitems.push_back(zmq::pollitem_t{node.socket_in, 0, ZMQ_POLLIN, 0});
+  }
+
+  std::vector<LoadPseudonym> pseudonyms;
+  std::unordered_map<uint64_t, PendingMessage> pending;
+  std::vector<double> latencies;
+  std::vector<double> delivery_lags;
+  uint64_t num_received = 0;
+  uint64_t num_duplicates = 0;
+  uint64_t num_foreign = 0;
+
+  // handles everything published by the nodes until timeout_ms has passed without a publication
+  auto receive = [&](long timeout_ms) {
+    while (zmq::poll(pollitems.data(), pollitems.size(), timeout_ms) > 0) {
+      for (size_t i = 0; i < nodes.size(); ++i) {
+        if (!(pollitems[i].revents & ZMQ_POLLIN)) {
+          continue;
+        }
+        zmq::message_t topic;
+        zmq::message_t content;
+        nodes[i].socket_in.recv(&topic);
+        nodes[i].socket_in.recv(&content);
+        auto now = Clock::now();
+        std::string topic_string(static_cast<const char *>(topic.data()), topic.size());
+        if (topic_string == kTopicGeneratedPseudonym && content.size() == sizeof(UserInterfaceGeneratedPseudonym)) {
+          UserInterfaceGeneratedPseudonym generated;
+          memcpy(&generated, content.data(), sizeof(generated));
+          LoadPseudonym pseudonym{i, {}, generated.time, now, {}};
+          std::copy(std::begin(generated.pseudonym), std::end(generated.pseudonym), pseudonym.pseudonym.begin());
+          pseudonyms.push_back(std::move(pseudonym));
+        } else if (content.size() == sizeof(UserInterfaceReceivedMessage)) {
+          UserInterfaceReceivedMessage received;
+          memcpy(&received, content.data(), sizeof(received));
+          LoadMessageHeader header;
+          memcpy(&header, received.msg, sizeof(header));
+          if (header.magic != kLoadMessageMagic) {
+            num_foreign++;
+            continue;
+          }
+          auto it = pending.find(header.sequence_number);
+          if (it == pending.end()) {
+            num_duplicates++;
+            continue;
+          }
+          num_received++;
+          latencies.push_back(std::chrono::duration<double>(now - it->second.sent_at).count());
+          delivery_lags.push_back(std::chrono::duration<double>(now - it->second.due_at).count());
+          pending.erase(it);
+        }
+      }
+    }
+  };
+
+  // give the subscriptions time to reach the nodes, then create the pseudonyms
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  for (auto &node : nodes) {
+    for (size_t i = 0; i < parameters.pseudonyms_per_node; ++i) {
+      zmq::message_t message(1);
+      static_cast<char *>(message.data())[0] = kUserCommandGeneratePseudonym;
+      node.socket_out.send(message);
+    }
+  }
+  auto expected_pseudonyms = nodes.size() * parameters.pseudonyms_per_node;
+  for (auto deadline = Clock::now() + std::chrono::seconds(10);
+       pseudonyms.size() < expected_pseudonyms && Clock::now() < deadline;) {
+    receive(100);
+  }
+  std::cout << "Created " << pseudonyms.size() << " of " << expected_pseudonyms << " pseudonyms" << std::endl;
+  if (pseudonyms.empty()) {
+    return -1;
+  }
+
+  // inject the messages at the target rate
+  std::mt19937_64 random(parameters.seed);
+  std::uniform_int_distribution<uint64_t> offset_distribution(parameters.t_dst_offset_min,
+                                                              parameters.t_dst_offset_max);
+  std::uniform_int_distribution<size_t> pseudonym_distribution(0, pseudonyms.size() - 1);
+  auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1 / parameters.rate));
+  auto start = Clock::now();
+  auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(parameters.duration));
+  auto latest_due = start;
+  uint64_t num_sent = 0;
+  uint64_t num_skipped = 0;
+  size_t next_source = 0;
+  // the messages due at the same time are sent to each node in one batch (kUserCommandSendMessages)
+  std::vector<std::vector<UserInterfaceMessageInjectionCommand>> batches(nodes.size());
+  for (auto next_send = start; next_send < end;) {
+    receive(std::max<long>(0, std::chrono::duration_cast<std::chrono::milliseconds>(next_send - Clock::now()).count()));
+    while (Clock::now() < next_send) {
+      receive(1);
+    }
+    auto now = Clock::now();
+    for (; next_send <= now && next_send < end; next_send += interval) {
+      auto offset = offset_distribution(random);
+
+      // the next source pseudonym (round robin) that may still send in the round of its t_dst
+      auto found = false;
+      for (size_t tried = 0; tried < pseudonyms.size() && !found; ++tried) {
+        auto &source = pseudonyms[next_source];
+        next_source = (next_source + 1) % pseudonyms.size();
+        auto t_dst = source.node_time_at(now) + offset;
+        auto &num_sent_for_round = source.num_sent_for_round[t_dst / (4 * kDelta)];
+        if (num_sent_for_round >= kSend) {
+          continue;
+        }
+        num_sent_for_round++;
+        found = true;
+
+        UserInterfaceMessageInjectionCommand injection_message;
+        memset(&injection_message, 0, sizeof(injection_message));
+        std::copy(source.pseudonym.begin(), source.pseudonym.end(), injection_message.n_src);
+        const auto &destination = pseudonyms[pseudonym_distribution(random)];
+        std::copy(destination.pseudonym.begin(), destination.pseudonym.end(), injection_message.n_dst);
+        injection_message.t_dst = t_dst;
+        LoadMessageHeader header{kLoadMessageMagic, num_sent};
+        memcpy(injection_message.msg, &header, sizeof(header));
+        batches[source.node].push_back(injection_message);
+
+        auto due_at = destination.generated_at
+            + std::chrono::seconds(static_cast<int64_t>(t_dst) - static_cast<int64_t>(destination.node_time));
+        pending.emplace(num_sent, PendingMessage{now, due_at});
+        latest_due = std::max(latest_due, due_at);
+        num_sent++;
+      }
+      if (!found) {
+        num_skipped++;
+      }
+    }
+
+    for (size_t node = 0; node < nodes.size(); ++node) {
+      auto &batch = batches[node];
+      if (batch.empty()) {
+        continue;
+      }
+      auto batch_size = batch.size() * sizeof(UserInterfaceMessageInjectionCommand);
+      zmq::message_t message(batch_size + 1);
+      static_cast<char *>(message.data())[0] = kUserCommandSendMessages;
+      memcpy(static_cast<char *>(message.data()) + 1, batch.data(), batch_size);
+      if (!nodes[node].socket_out.send(message)) {
+        return -1;
+      }
+      batch.clear();
+    }
+  }
+  auto send_duration = std::chrono::duration<double>(Clock::now() - start).count();
+  std::cout << "Injected " << num_sent << " messages in " << send_duration << " s (" << num_sent / send_duration
+            << " messages/s), skipped " << num_skipped << " (send limit per round)" << std::endl;
+
+  // wait for the remaining messages
+  auto drain_end = latest_due
+      + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(parameters.drain));
+  while (!pending.empty() && Clock::now() < drain_end) {
+    receive(100);
+  }
+
+  std::cout << "Received " << num_received << " of " << num_sent << " messages, lost " << pending.size() << " ("
+            << (num_sent ? 100.0 * pending.size() / num_sent : 0) << " %), " << num_duplicates
+            << " unexpected or duplicate, " << num_foreign << " foreign" << std::endl;
+  print_distribution("Latency (injection to delivery)", latencies);
+  print_distribution("Delivery lag (t_dst to delivery)", delivery_lags);
+  return pending.empty() ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+#ifndef NETWORK_SGX_EXAMPLE_QUORUM_ASSIGNMENT_H
+#define NETWORK_SGX_EXAMPLE_QUORUM_ASSIGNMENT_H
+
+#include <cstdint>
+#include <vector>
+#include <map>
+#include <string>
+#include <numeric>
+#include <algorithm>
+
+namespace c1::server {
+
+/**
+ * Draws a number uniformly from [0, bound) (rejection sampling, so that there is no modulo bias).
+ * @param bound must be positive
+ * @param random returns uniformly distributed 64 bit numbers
+ */
+template<typename RandomSource>
+uint64_t uniform_below(uint64_t bound, RandomSource &random) {
+  // the numbers below threshold are rejected, so that the remaining range is a multiple of bound
+  uint64_t threshold = (0 - bound) % bound;
+  while (true) {
+    uint64_t random_number = random();
+    if (random_number >= threshold) {
+      return random_number % bound;
+    }
+  }
+}
+
+/**
+ * Assigns each of num_clients clients to one of num_quorums quorums such that the quorum sizes differ by at most one.
+ * Which client gets into which quorum is determined by a uniformly random permutation of the clients (Fisher-Yates),
+ * which is cut into num_quorums consecutive blocks.
+ * @param num_clients
+ * @param num_quorums must be positive (quorums stay empty if num_clients < num_quorums)
+ * @param random returns uniformly distributed 64 bit numbers (cryptographically secure ones inside the enclave)
+ * @return the quorum of each client
+ */
+template<typename RandomSource>
+std::vector<uint64_t> assign_balanced_quorums(uint64_t num_clients, uint64_t num_quorums, RandomSource &&random) {
+  std::vector<uint64_t> permutation(num_clients);
+  std::iota(permutation.begin(), permutation.end(), 0);
+  for (uint64_t i = num_clients; i > 1; --i) {
+    std::swap(permutation[i - 1], permutation[uniform_below(i, random)]);
+  }
+
+  std::vector<uint64_t> quorum_of_client(num_clients);
+  for (uint64_t position = 0; position < num_clients; ++position) {
+    quorum_of_client[permutation[position]] = position * num_quorums / num_clients;
+  }
+  return quorum_of_client;
+}
+
+/**
+ * Sizes of the quorums of an assignment.
+ */
+struct QuorumSizeDistribution {
+  size_t min_size = 0;
+  size_t max_size = 0;
+  double mean_size = 0;
+  /** maps each size to the number of quorums of that size */
+  std::map<size_t, uint64_t> num_quorums_of_size;
+
+  QuorumSizeDistribution(const std::vector<uint64_t> &quorum_of_client, uint64_t num_quorums) {
+    std::vector<size_t> sizes(num_quorums);
+    for (auto quorum : quorum_of_client) {
+      sizes.at(quorum)++;
+    }
+    for (auto size : sizes) {
+      num_quorums_of_size[size]++;
+    }
+    if (num_quorums > 0) {
+      min_size = num_quorums_of_size.begin()->first;
+      max_size = num_quorums_of_size.rbegin()->first;
+      mean_size = static_cast<double>(quorum_of_client.size()) / num_quorums;
+    }
+  }
+
+  std::string to_string() const {
+    std::string result = "min " + std::to_string(min_size) + ", max " + std::to_string(max_size) + ", mean "
+        + std::to_string(mean_size) + " (size: #quorums";
+    for (const auto &[size, num_quorums] : num_quorums_of_size) {
+      result += ", " + std::to_string(size) + ": " + std::to_string(num_quorums);
+    }
+    return result + ")";
+  }
+};
+
+}
+
+#endif //NETWORK_SGX_EXAMPLE_QUORUM_ASSIGNMENT_H
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <sgx_trts.h>
 #include "server_enclave.h"
+#include "quorum_assignment.h"
 #include "enclave_t.h"
 #include "../../include/errors.h"
 #include "../../include/shared_functions.h"
@@ -7,38 +9,207 @@
 
 namespace c1::server {
 
-void ServerEnclave::init() {
-  ocall_print_string("ServerEnclave initialized!\n");
+void ServerEnclave::init(uint64_t num_required_clients, uint32_t shard, uint32_t num_shards, const char *shard_uris,
+                         const uint8_t *sk_shards, size_t key_len) {
+  num_required_clients_ = std::max<uint64_t>(num_required_clients, 2 * kNumNodesPerQuorum);
+  num_shards_ = std::max<uint32_t>(num_shards, 1);
+  shard_ = shard;
+  int dimension = 1;
+  while ((uint64_t{2} << dimension) * kNumNodesPerQuorum <= num_required_clients_) {
+    dimension++;
+  }
+  set_dimension(dimension);
+  if (num_shards_ > 1) {
+    if (!set_shard_uris(shard_uris)) {
+      ocall_print_string(("ServerEnclave got malformed uris of the shards: " + std::string(shard_uris) + "\n").c_str());
+      abort();
+    }
+    if (key_len == sizeof(sk_shards_)) {
+      std::copy(sk_shards, sk_shards + key_len, sk_shards_);
+    } else if (key_len == 0) {
+      derive_shard_key();
+    } else {
+      ocall_print_string("ServerEnclave got a key of the shards of the wrong length!\n");
+      abort();
+    }
+    if (sgx_read_rand(reinterpret_cast<unsigned char *>(&session_), sizeof(session_)) != SGX_SUCCESS) {
+      ocall_print_string("sgx_read_rand failed while drawing the session!\n");
+      abort();
+    }
+    if (!is_leader()) {
+      send_hello(0);
+    }
+  }
+  clients_.reserve(num_required_clients_);
+  std::string role = num_shards_ == 1 ? "" : (is_leader() ? ", leader of " : ", follower of ")
+      + std::to_string(num_shards_) + " shards";
+  ocall_print_string(("ServerEnclave initialized (waiting for " + std::to_string(num_required_clients_)
+      + " clients, overlay dimension " + std::to_string(dimension_) + role + ")!\n").c_str());
+}
+
+void ServerEnclave::derive_shard_key() {
+  // the seal key bound to MRENCLAVE is the same for every instance of this enclave on this platform, and no other
+  // enclave can derive it; thus it only serves shards that run on the same machine (see README)
+  sgx_key_request_t request{};
+  const auto *report = sgx_self_report();
+  request.key_name = SGX_KEYSELECT_SEAL;
+  request.key_policy = SGX_KEYPOLICY_MRENCLAVE;
+  request.isv_svn = report->body.isv_svn;
+  request.cpu_svn = report->body.cpu_svn;
+  request.attribute_mask.flags = SGX_FLAGS_INITTED | SGX_FLAGS_DEBUG | SGX_FLAGS_MODE64BIT;
+  const char key_label[] = "c1 login server shards";
+  std::copy(std::begin(key_label), std::end(key_label), request.key_id.id);
+  if (sgx_get_key(&request, &sk_shards_) != SGX_SUCCESS) {
+    ocall_print_string("sgx_get_key failed while deriving the key of the shards!\n");
+    abort();
+  }
+}
+
+bool ServerEnclave::set_shard_uris(const std::string &shard_uris) {
+  shards_.assign(num_shards_, {});
+  if (shard_uris.empty()) {
+    for (uint32_t shard = 0; shard < num_shards_; ++shard) {
+      shards_[shard].uri = Uri(127, 0, 0, 1, kLoginServerPort + shard);
+    }
+    return true;
+  }
+  size_t begin = 0;
+  for (uint32_t shard = 0; shard < num_shards_; ++shard) {
+    auto end = std::min(shard_uris.find(',', begin), shard_uris.size());
+    if (!Uri::parse(shard_uris.substr(begin, end - begin), shards_[shard].uri)) {
+      return false;
+    }
+    begin = end + 1;
+  }
+  return begin == shard_uris.size() + 1;
 }
 
-void ServerEnclave::received_msg_from_client(const void *ptr, size_t len) {
-  if (get_message_type(ptr) == kTypeJoinMessage) {
+bool ServerEnclave::all_shards_connected() const {
+  return std::all_of(shards_.begin() + 1, shards_.end(), [](const ShardSession &s) { return s.hello_received; });
+}
 
-    assert(sizeof(JoinMessage) == len);
-    const JoinMessage received_message = *reinterpret_cast<const JoinMessage *>(ptr);
-    ocall_print_string("ServerEnclave received join message from: \n");
-    ocall_print_string(received_message.to_string().c_str());
+void ServerEnclave::set_dimension(int dimension) {
+  dimension_ = dimension;
+  num_quorum_nodes_ = uint64_t{1} << dimension_;
+}
 
-    if (clients_.size() < kNumRequiredClients) {
-      clients_.emplace_back(received_message.sender);
-      ocall_print_string(
-          ("Current number of registered peers: " + std::to_string(clients_.size()) + "\n").c_str());
-      if (clients_.size() >= kNumRequiredClients) {
-        initialize_system();
+bool ServerEnclave::add_client(const PeerInformation &client, uint32_t shard) {
+  if (clients_.size() >= num_required_clients_) {
+    return false;
+  }
+  auto[it, inserted] = client_index_for_uri_.try_emplace(client.uri, clients_.size());
+  if (!inserted) {
+    num_duplicate_joins_++;
+    return false;
+  }
+  clients_.emplace_back(client);
+  clients_shards_.push_back(shard);
+  return true;
+}
+
+int ServerEnclave::received_msg_from_client(const void *ptr, size_t len) {
+  if (bootstrap_prepared_) {
+    return bootstrap_prepared_;
+  }
+  auto msg_type = get_message_type(ptr);
+  if (len == sizeof(JoinMessage) && msg_type == kTypeJoinMessage) {
+    JoinMessage received_message = *reinterpret_cast<const JoinMessage *>(ptr);
+    if (add_client(received_message.sender, shard_) && !is_leader()) {
+      joins_to_forward_.emplace_back(received_message.sender, shard_, 0, 0);
+    }
+  } else if (msg_type == kTypeShardHelloMessage || (msg_type == kTypeShardJoinsMessage && is_leader())
+      || (msg_type == kTypeShardPlanMessage && !is_leader())) {
+    // the messages between the shards arrive at the same socket as those of the clients, so only those that were
+    // encrypted by another shard (of this run) are accepted
+    std::vector<uint8_t> shard_msg;
+    uint32_t from_shard;
+    if (!open_from_shard(ptr, len, shard_msg, from_shard)) {
+      ocall_print_string("ServerEnclave dropped a message between shards that could not be authenticated!\n");
+    } else if (msg_type == kTypeShardHelloMessage) {
+      ocall_print_string(("Shard " + std::to_string(from_shard) + " connected.\n").c_str());
+      if (is_leader()) {
+        send_hello(from_shard);
       }
+    } else if (msg_type == kTypeShardJoinsMessage) {
+      received_joins(shard_msg.data(), shard_msg.size());
+    } else {
+      received_plan(shard_msg.data(), shard_msg.size());
+    }
+  }
+
+  // the plan is only prepared once every follower can receive it
+  if (is_leader() && clients_.size() >= num_required_clients_ && all_shards_connected()) {
+    prepare_bootstrap();
+  }
+  return bootstrap_prepared_;
+}
+
+int ServerEnclave::received_msgs_from_clients(const char *batch, size_t len) {
+  auto num_clients_before = clients_.size();
+  size_t cur = 0;
+  while (cur + sizeof(ClientMessageBatchRecordHeader) <= len) {
+    ClientMessageBatchRecordHeader record_header;
+    memcpy(&record_header, batch + cur, sizeof(record_header));
+    cur += sizeof(record_header);
+    if (record_header.msg_len > len - cur) {
+      ocall_print_string("ServerEnclave received a malformed batch of client messages!\n");
+      break;
+    }
+    if (record_header.msg_len >= sizeof(uint64_t)) {
+      received_msg_from_client(batch + cur, record_header.msg_len);
     }
+    cur += record_header.msg_len;
   }
+  if (!joins_to_forward_.empty() && !is_leader() && shards_[0].hello_received) {
+    forward_joins();
+  }
+  // one progress report per batch (instead of one per join message)
+  if (clients_.size() != num_clients_before && !bootstrap_prepared_) {
+    ocall_print_string(("Current number of registered peers: " + std::to_string(clients_.size())
+        + (num_duplicate_joins_ ? " (" + std::to_string(num_duplicate_joins_) + " duplicate joins ignored)" : "")
+        + "\n").c_str());
+  }
+  return bootstrap_prepared_;
+}
+
+void ServerEnclave::received_joins(const uint8_t *ptr, size_t len) {
+  ShardJoinsMessageHeader header;
+  if (len < sizeof(header)) {
+    return;
+  }
+  memcpy(&header, ptr, sizeof(header));
+  if ((len - sizeof(header)) / sizeof(ShardClientRecord) != header.num_clients
+      || (len - sizeof(header)) % sizeof(ShardClientRecord) != 0) {
+    ocall_print_string("ServerEnclave received a malformed joins message from a shard!\n");
+    return;
+  }
+  for (uint64_t i = 0; i < header.num_clients; ++i) {
+    ShardClientRecord record;
+    memcpy(&record, ptr + sizeof(header) + i * sizeof(record), sizeof(record));
+    if (record.shard < num_shards_) {
+      add_client(record.peer(), record.shard);
+    }
+  }
+}
+
+void ServerEnclave::forward_joins() {
+  ShardJoinsMessageHeader header;
+  header.num_clients = joins_to_forward_.size();
+  std::vector<char> msg(sizeof(header) + joins_to_forward_.size() * sizeof(ShardClientRecord));
+  memcpy(msg.data(), &header, sizeof(header));
+  memcpy(msg.data() + sizeof(header), joins_to_forward_.data(), joins_to_forward_.size() * sizeof(ShardClientRecord));
+  send_to_shard(0, msg);
+  joins_to_forward_.clear();
 }
 
 int ServerEnclave::main_loop() {
   return !initialized;
 }
 
-void ServerEnclave::try_and_send_msg(std::string client_uri, char *msg_raw, int msg_len, std::string msg_desc) const {
-  sgx_status_t ret = ocall_send_msg_to_client(client_uri.c_str(), msg_raw, msg_len);
+void ServerEnclave::try_and_send_batch(const std::vector<char> &batch) const {
+  sgx_status_t ret = ocall_send_msgs_to_clients(batch.data(), batch.size());
   if (ret != SGX_SUCCESS) {
-    std::string error_text = "ocall for sending " + msg_desc + " failed......\n";
-    ocall_print_string(error_text.c_str());
+    ocall_print_string("ocall for sending a batch of init msgs failed......\n");
     for (int idx = 0; idx < sizeof sgx_errlist / sizeof sgx_errlist[0]; idx++) {
       if (ret == sgx_errlist[idx].err) {
         ocall_print_string(sgx_errlist[idx].msg);
@@ -47,80 +218,262 @@ void ServerEnclave::try_and_send_msg(std::string client_uri, char *msg_raw, int
   }
 }
 
-void ServerEnclave::initialize_system() {
+void ServerEnclave::send_to_shard(uint32_t shard, const std::vector<char> &msg) {
+  auto &session = shards_.at(shard);
+  ShardMessageAad aad{shard_, shard, session_, session.session, session.next_seq_out++};
+  // the type stays readable, so that the receiving shard can tell the message from those of the clients
+  auto c = cryptlib::encrypt(sk_shards_, std::vector<uint8_t>(msg.begin(), msg.end()),
+                             std::vector<uint8_t>(reinterpret_cast<const uint8_t *>(&aad),
+                                                  reinterpret_cast<const uint8_t *>(&aad) + sizeof(aad)));
+  auto uri = std::string(session.uri);
+  BootstrapBatchRecordHeader record_header{uri.size(), sizeof(uint64_t) + c.size()};
+  std::vector<char> batch(sizeof(record_header));
+  memcpy(batch.data(), &record_header, sizeof(record_header));
+  batch.insert(batch.end(), uri.begin(), uri.end());
+  batch.insert(batch.end(), msg.begin(), msg.begin() + sizeof(uint64_t));
+  batch.insert(batch.end(), c.begin(), c.end());
+  try_and_send_batch(batch);
+}
+
+void ServerEnclave::send_hello(uint32_t shard) {
+  ShardHelloMessage hello;
+  std::vector<char> msg(sizeof(hello));
+  memcpy(msg.data(), &hello, sizeof(hello));
+  send_to_shard(shard, msg);
+}
+
+bool ServerEnclave::open_from_shard(const void *ptr, size_t len, std::vector<uint8_t> &msg, uint32_t &from_shard) {
+  if (num_shards_ == 1 || len < sizeof(uint64_t)) {
+    return false;
+  }
+  msg.assign(static_cast<const uint8_t *>(ptr) + sizeof(uint64_t), static_cast<const uint8_t *>(ptr) + len);
+  cryptlib::CiphertextRanges ranges;
+  ShardMessageAad aad;
+  if (!cryptlib::decrypt_in_place(sk_shards_, msg, ranges) || ranges.p_len < sizeof(uint64_t)
+      || ranges.aad_len != sizeof(aad)) {
+    return false;
+  }
+  memcpy(&aad, msg.data() + ranges.aad_begin, sizeof(aad));
+  msg.erase(msg.begin(), msg.begin() + ranges.p_begin);
+  msg.resize(ranges.p_len);
+  // the type in the clear must be the one that was encrypted, the followers only talk to the leader
+  auto msg_type = get_message_type(msg.data());
+  if (msg_type != get_message_type(ptr) || aad.to_shard != shard_ || aad.from_shard >= num_shards_
+      || aad.from_shard == shard_ || (!is_leader() && aad.from_shard != 0)) {
+    return false;
+  }
+
+  auto &session = shards_[aad.from_shard];
+  if (msg_type == kTypeShardHelloMessage) {
+    // the hello of the leader answers the one of this run, the hello of a follower opens its session
+    if (!is_leader() && aad.receiver_session != session_) {
+      return false;
+    }
+    if (!session.hello_received || aad.sender_session != session.session) {
+      session.hello_received = true;
+      session.session = aad.sender_session;
+      session.last_seq_in = 0;
+    }
+  } else if (!session.hello_received || aad.sender_session != session.session || aad.receiver_session != session_) {
+    return false; // of another run
+  }
+  if (aad.seq <= session.last_seq_in) {
+    return false; // replayed
+  }
+  session.last_seq_in = aad.seq;
+  from_shard = aad.from_shard;
+  return true;
+}
+
+void ServerEnclave::prepare_bootstrap() {
   ocall_print_string("Ready to initialize the system.\n");
 
   //Generate keys
-  std::array<uint8_t, SGX_AESGCM_KEY_SIZE> sk_pseud = c1::cryptlib::keygen();
-  std::array<uint8_t, SGX_AESGCM_KEY_SIZE> sk_enc = c1::cryptlib::keygen();
-  std::array<uint8_t, SGX_CMAC_KEY_SIZE> sk_routing = c1::cryptlib::gen_routing_key();
+  plan_.sk_pseud = c1::cryptlib::keygen();
+  plan_.sk_enc = c1::cryptlib::keygen();
+  plan_.sk_routing = c1::cryptlib::gen_routing_key();
 
   //Initialize overlay schemes
   for (int i = 0; i < clients_.size(); ++i) {
     clients_[i].id = i;
   }
 
-  std::vector<std::vector<PeerInformation>> associated_quorums; // stores, for each quorum, the associated nodes
-  std::vector<std::vector<PeerInformation>>
-      emulated_quorums(kNumQuorumNodes); // stores, for each quorum, the nodes emulating this quorum
-  std::vector<uint64_t> clients_associated_quorums
-      (kNumRequiredClients); // stores redundant data, used for efficiency, maps each client to its associated quorum
-  std::vector<uint64_t> clients_emulated_quorums
-      (kNumRequiredClients); // stores redundant data, used for efficiency, maps each client to the quorum it emulates
+  // the clients are associated to the quorums in consecutive blocks of (almost) equal size
+  plan_.clients_associated_quorums.resize(num_required_clients_);
+  for (uint64_t j = 0; j < num_required_clients_; ++j) {
+    plan_.clients_associated_quorums[j] = j * num_quorum_nodes_ / num_required_clients_;
+  }
 
-  for (int i = 0; i < kNumQuorumNodes; ++i) {
-    associated_quorums.push_back(std::vector<PeerInformation>());
+  // the emulated quorums are assigned by a random permutation, so that they are of (almost) equal size: the largest
+  // quorum determines the padding of the routing messages
+  plan_.clients_emulated_quorums = assign_balanced_quorums(num_required_clients_, num_quorum_nodes_, [] {
+    uint64_t random_number;
+    if (sgx_read_rand(reinterpret_cast<unsigned char *>(&random_number), sizeof(random_number)) != SGX_SUCCESS) {
+      ocall_print_string("sgx_read_rand failed while assigning the quorums!\n");
+      abort();
+    }
+    return random_number;
+  });
+  ocall_print_string(("Sizes of the emulated quorums: "
+      + QuorumSizeDistribution(plan_.clients_emulated_quorums, num_quorum_nodes_).to_string() + "\n").c_str());
+  // the plan is only sent to the followers if it is usable
+  if (!build_quorum_tables()) {
+    ocall_print_string("ServerEnclave could not build the quorum tables!\n");
+    abort();
+  }
 
-    for (int j = i * kNumNodesPerQuorum;
-         j < (i + 1) * kNumNodesPerQuorum || (i == kNumQuorumNodes - 1 && j < kNumRequiredClients); ++j) {
-      associated_quorums.at(i).push_back(clients_.at(j));
-      clients_associated_quorums[j] = i;
+  if (num_shards_ > 1) {
+    // the followers build the init messages of their clients from the same plan
+    ShardPlanMessageHeader header;
+    header.num_clients = clients_.size();
+    header.dimension = dimension_;
+    std::copy(plan_.sk_pseud.begin(), plan_.sk_pseud.end(), header.sk_pseud);
+    std::copy(plan_.sk_enc.begin(), plan_.sk_enc.end(), header.sk_enc);
+    std::copy(plan_.sk_routing.begin(), plan_.sk_routing.end(), header.sk_routing);
+    std::vector<char> msg(sizeof(header) + clients_.size() * sizeof(ShardClientRecord));
+    memcpy(msg.data(), &header, sizeof(header));
+    for (uint64_t i = 0; i < clients_.size(); ++i) {
+      ShardClientRecord record(clients_[i], clients_shards_[i], plan_.clients_associated_quorums[i],
+                               plan_.clients_emulated_quorums[i]);
+      memcpy(msg.data() + sizeof(header) + i * sizeof(record), &record, sizeof(record));
+    }
+    for (uint32_t shard = 1; shard < num_shards_; ++shard) {
+      send_to_shard(shard, msg);
     }
   }
+}
 
-  for (int i = 0; i < kNumRequiredClients; ++i) {
-    uint64_t random_number;
-    sgx_read_rand((unsigned char *) &random_number, 8);
-    uint64_t random_quorum = random_number % kNumQuorumNodes;
-    emulated_quorums.at(random_quorum).push_back(clients_.at(i));
-    clients_emulated_quorums[i] = random_quorum;
+void ServerEnclave::received_plan(const uint8_t *ptr, size_t len) {
+  ShardPlanMessageHeader header;
+  if (len < sizeof(header)) {
+    return;
+  }
+  memcpy(&header, ptr, sizeof(header));
+  if ((len - sizeof(header)) % sizeof(ShardClientRecord) != 0
+      || (len - sizeof(header)) / sizeof(ShardClientRecord) != header.num_clients
+      || header.dimension == 0 || header.dimension >= 64) {
+    ocall_print_string("ServerEnclave received a malformed plan from the leader!\n");
+    return;
   }
 
-  for (int i = 0; i < kNumQuorumNodes; ++i) {
-    assert(emulated_quorums.at(i).size() > 0);
-    ocall_print_string((std::string("Quorum ") + std::to_string(i) + " is emulated by: ").c_str());
-    for (auto client : emulated_quorums.at(i)) {
-      ocall_print_string((std::to_string(client.id) + ", ").c_str());
+  // validate all of the plan before taking it over
+  uint64_t num_quorum_nodes = uint64_t{1} << header.dimension;
+  std::vector<PeerInformation> clients;
+  std::vector<uint32_t> clients_shards;
+  std::vector<uint64_t> clients_associated_quorums, clients_emulated_quorums;
+  clients.reserve(header.num_clients);
+  clients_shards.reserve(header.num_clients);
+  clients_associated_quorums.reserve(header.num_clients);
+  clients_emulated_quorums.reserve(header.num_clients);
+  std::vector<bool> emulated(num_quorum_nodes, false);
+  for (uint64_t i = 0; i < header.num_clients; ++i) {
+    ShardClientRecord record;
+    memcpy(&record, ptr + sizeof(header) + i * sizeof(record), sizeof(record));
+    if (record.associated_quorum >= num_quorum_nodes || record.emulated_quorum >= num_quorum_nodes
+        || record.shard >= num_shards_) {
+      ocall_print_string("ServerEnclave received a malformed plan from the leader!\n");
+      return;
     }
-    ocall_print_string("\n");
+    emulated[record.emulated_quorum] = true;
+    clients.push_back(record.peer());
+    clients_shards.push_back(record.shard);
+    clients_associated_quorums.push_back(record.associated_quorum);
+    clients_emulated_quorums.push_back(record.emulated_quorum);
+  }
+  if (std::find(emulated.begin(), emulated.end(), false) != emulated.end()) { // (see build_quorum_tables)
+    ocall_print_string("ServerEnclave received a plan with quorums that nobody emulates from the leader!\n");
+    return;
   }
 
-  // send the init message to every client:
-  for (int i = 0; i < kNumRequiredClients; ++i) {
+  std::copy(std::begin(header.sk_pseud), std::end(header.sk_pseud), plan_.sk_pseud.begin());
+  std::copy(std::begin(header.sk_enc), std::end(header.sk_enc), plan_.sk_enc.begin());
+  std::copy(std::begin(header.sk_routing), std::end(header.sk_routing), plan_.sk_routing.begin());
+  set_dimension(header.dimension);
+  num_required_clients_ = header.num_clients;
+  clients_ = std::move(clients);
+  clients_shards_ = std::move(clients_shards);
+  plan_.clients_associated_quorums = std::move(clients_associated_quorums);
+  plan_.clients_emulated_quorums = std::move(clients_emulated_quorums);
+  ocall_print_string(("Received the plan of the leader (" + std::to_string(header.num_clients) + " clients).\n").c_str());
+  if (!build_quorum_tables()) {
+    ocall_print_string("ServerEnclave could not build the quorum tables from the plan of the leader!\n");
+  }
+}
 
+bool ServerEnclave::build_quorum_tables() {
+  auto &associated_quorums = plan_.associated_quorums;
+  auto &emulated_quorums = plan_.emulated_quorums;
+  associated_quorums.assign(num_quorum_nodes_, {});
+  emulated_quorums.assign(num_quorum_nodes_, {});
+  own_clients_.clear();
+  for (uint64_t i = 0; i < clients_.size(); ++i) {
+    associated_quorums.at(plan_.clients_associated_quorums[i]).push_back(clients_[i]);
+    emulated_quorums.at(plan_.clients_emulated_quorums[i]).push_back(clients_[i]);
+    if (clients_shards_[i] == shard_) {
+      own_clients_.push_back(i);
+    }
+  }
+  // every quorum has to be emulated by somebody, otherwise gamma_send of its associated clients is empty
+  for (uint64_t i = 0; i < num_quorum_nodes_; ++i) {
+    if (emulated_quorums.at(i).empty()) {
+      ocall_print_string(("ServerEnclave: nobody emulates quorum " + std::to_string(i) + "!\n").c_str());
+      return false;
+    }
+  }
+
+  // gamma_route is the same for all nodes emulating a quorum
+  plan_.gamma_route_for_quorum.assign(num_quorum_nodes_, {});
+  for (uint64_t quorum = 0; quorum < num_quorum_nodes_; ++quorum) {
+    auto &gamma_route = plan_.gamma_route_for_quorum[quorum];
+    for_all_neighbors(quorum, dimension_, [&gamma_route, &emulated_quorums](uint64_t neighbor_quorum) {
+      gamma_route[neighbor_quorum] = emulated_quorums.at(neighbor_quorum);
+    });
+  }
+  bootstrap_prepared_ = true;
+  return true;
+}
+
+void ServerEnclave::bootstrap_worker(size_t worker, size_t num_workers) {
+  if (!bootstrap_prepared_ || initialized) {
+    return;
+  }
+
+  std::vector<char> batch;
+  batch.reserve(2 * kBootstrapBatchSize);
+  for (size_t own = worker; own < own_clients_.size(); own += num_workers) {
+    auto i = own_clients_[own];
     // gamma_send : all nodes that emulate the quorum node that i is associated with
-    std::vector<PeerInformation> gamma_send = emulated_quorums.at(clients_associated_quorums[i]);
+    const auto &gamma_send = plan_.emulated_quorums.at(plan_.clients_associated_quorums[i]);
     // gamma_receive: all nodes that are associated with the quorum node that i emulates
-    std::vector<PeerInformation> gamma_receive = associated_quorums.at(clients_emulated_quorums[i]);
-    std::map<uint64_t, std::vector<PeerInformation>> gamma_route;
+    const auto &gamma_receive = plan_.associated_quorums.at(plan_.clients_emulated_quorums[i]);
+    const auto &gamma_route = plan_.gamma_route_for_quorum.at(plan_.clients_emulated_quorums[i]);
 
-    for_all_neighbors(clients_emulated_quorums[i],
-                      kDimension,
-                      [&gamma_route, &emulated_quorums](uint64_t neighbor_quorum) {
-                        gamma_route[neighbor_quorum] = emulated_quorums.at(neighbor_quorum);
-                      });
+    auto uri = std::string(clients_[i].uri);
+    // the length of the init message is only known after serializing it, so the record header is patched afterwards
+    BootstrapBatchRecordHeader record_header{uri.size(), 0};
+    auto header_offset = batch.size();
+    batch.resize(header_offset + sizeof(record_header));
+    batch.insert(batch.end(), uri.begin(), uri.end());
+    auto msg_offset = batch.size();
+    InitMessage::serialize_to(batch, clients_[i].id, num_required_clients_, dimension_,
+                              plan_.clients_associated_quorums[i], plan_.clients_emulated_quorums[i],
+                              gamma_send, gamma_receive, gamma_route,
+                              plan_.sk_pseud, plan_.sk_enc, plan_.sk_routing);
+    record_header.msg_len = batch.size() - msg_offset;
+    memcpy(batch.data() + header_offset, &record_header, sizeof(record_header));
 
-    InitMessage init_message(clients_[i].id, kNumRequiredClients, kDimension,
-                             clients_associated_quorums[i], clients_emulated_quorums[i],
-                             gamma_send, gamma_receive, gamma_route, sk_pseud, sk_enc, sk_routing);
+    if (batch.size() >= kBootstrapBatchSize) {
+      try_and_send_batch(batch);
+      batch.clear();
+    }
+  }
+  if (!batch.empty()) {
+    try_and_send_batch(batch);
+  }
 
-    auto init_message_serialized = init_message.serialize();
-    try_and_send_msg(clients_[i].uri,
-                     init_message_serialized.first.get(),
-                     init_message_serialized.second,
-                     "init msg to client " + std::to_string(i));
+  if (++num_finished_workers_ == num_workers) {
+    initialized = true;
   }
-  initialized = true;
 }
 
-} // ~namespace
\ No newline at end of file
+} // ~namespace
@@ -4,19 +4,21 @@
 #include <cstdlib>
 #include <cassert>
 #include <vector>
+#include <map>
+#include <unordered_map>
 #include <string>
+#include <atomic>
+#include <sgx_utils.h>
 #include "../../include/shared_structs.h"
 
 namespace c1::server {
 
-/** currently hardcodes the number of clients */
-constexpr int kNumRequiredClients{81};
-/** currently hardcodes the dimension of the overlay network */
-constexpr int kDimension{3};
+/** the number of clients if none is given to ecall_init */
+constexpr uint64_t kDefaultNumRequiredClients{81};
 /** currently hardcodes the desired number of nodes associated to each quorum */
 constexpr int kNumNodesPerQuorum{10};
-/** the total number of nodes in the overlay network */
-constexpr int kNumQuorumNodes = 1 << kDimension;
+/** the init messages are passed to the untrusted part in batches of (at least) this size */
+constexpr size_t kBootstrapBatchSize{256 * 1024};
 
 /**
  * The enclave of the login server.
@@ -36,17 +38,148 @@ public:
       return INSTANCE;
   }
 
-    void init();
-    void received_msg_from_client(const void *ptr, size_t len);
+    /**
+     * @param num_required_clients the number of clients (of all shards together)
+     * @param shard the shard of a sharded login server this enclave belongs to (0 is the leader)
+     * @param num_shards 1 if the login server is not sharded
+     * @param shard_uris the uris of the shards, separated by commas (empty: shard k listens on kLoginServerPort + k of
+     * localhost)
+     * @param sk_shards the key protecting the messages between the shards (the same for all shards), if key_len is 0 it
+     * is derived from the seal key (all shards have to run on the same machine then)
+     * @param key_len
+     */
+    void init(uint64_t num_required_clients, uint32_t shard, uint32_t num_shards, const char *shard_uris,
+              const uint8_t *sk_shards, size_t key_len);
+    /**
+     * @return true iff all clients have joined, i.e., the bootstrap workers can be started
+     */
+    int received_msg_from_client(const void *ptr, size_t len);
+    /**
+     * Handles a batch of client messages (see ClientMessageBatchRecordHeader).
+     * @return true iff all clients have joined, i.e., the bootstrap workers can be started
+     */
+    int received_msgs_from_clients(const char *batch, size_t len);
     int main_loop();
+    /**
+     * Serializes the init messages of the (own) clients worker, worker + num_workers, ... and passes them to the
+     * untrusted part in batches. Runs concurrently in num_workers threads (the plan is only read).
+     * @param worker
+     * @param num_workers
+     */
+    void bootstrap_worker(size_t worker, size_t num_workers);
 
 
 private:
-    void try_and_send_msg(std::string client_uri, char *msg_raw, int msg_len, std::string msg_desc) const;
-    void initialize_system();
+    void try_and_send_batch(const std::vector<char> &batch) const;
+    /**
+     * Passes msg to the untrusted part to be sent to the given shard of the login server. Only its type is sent in the
+     * clear, the message itself is encrypted with sk_shards_ and bound to the sessions of both shards (see
+     * ShardMessageAad and open_from_shard).
+     */
+    void send_to_shard(uint32_t shard, const std::vector<char> &msg);
+    /**
+     * Decrypts a message sent by send_to_shard of another shard and checks that it belongs to the current sessions and
+     * has not been received before (a hello opens the session of its sender).
+     * @param from_shard set to the sender
+     * @return false if the message could not be authenticated or is not fresh (msg must not be used then)
+     */
+    bool open_from_shard(const void *ptr, size_t len, std::vector<uint8_t> &msg, uint32_t &from_shard);
+    /** sends a ShardHelloMessage to shard (see ShardHelloMessage) */
+    void send_hello(uint32_t shard);
+    /** derives sk_shards_ (the same key in all shards, as they run the same enclave on the same platform) */
+    void derive_shard_key();
+    /**
+     * Sets the uris of the shards (see init).
+     * @return false if shard_uris is malformed or does not contain num_shards_ uris
+     */
+    bool set_shard_uris(const std::string &shard_uris);
+    /** (leader) whether all followers have sent their hello, i.e., can receive the plan */
+    bool all_shards_connected() const;
+    /**
+     * Adds a client that has joined at shard (unless its uri has already joined).
+     * @return true iff the client has been added
+     */
+    bool add_client(const PeerInformation &client, uint32_t shard);
+    /** (leader) assigns the ids and the quorums and generates the keys, then passes the plan to the followers */
+    void prepare_bootstrap();
+    /** (leader) adds the clients that joined at a follower */
+    void received_joins(const uint8_t *ptr, size_t len);
+    /** (follower) takes over the plan of the leader (only if all of it is valid) */
+    void received_plan(const uint8_t *ptr, size_t len);
+    /**
+     * Builds the quorum tables of plan_ from the quorums of the clients and determines the own clients.
+     * @return false (and the bootstrap is not prepared) if a quorum is emulated by nobody
+     */
+    bool build_quorum_tables();
+    /** (follower) passes the clients that joined since the last call to the leader (once its session is known) */
+    void forward_joins();
+    void set_dimension(int dimension);
+
+    bool is_leader() const {
+      return shard_ == 0;
+    }
 
     std::vector<PeerInformation> clients_; //very simple: each client gets added with its uri and id
-  bool initialized = false;
+    /** maps the uri of each joined client to its position in clients_ (a client joining twice is only added once) */
+    std::unordered_map<Uri, size_t, UriHash> client_index_for_uri_;
+    /** the number of join messages ignored since their uri has already joined */
+    uint64_t num_duplicate_joins_ = 0;
+    /** the shard each client has joined at (same order as clients_) */
+    std::vector<uint32_t> clients_shards_;
+    /** the positions of the clients (in clients_) that have joined at this shard, i.e., whose init messages it sends */
+    std::vector<uint64_t> own_clients_;
+    /** (follower) the clients not passed to the leader yet */
+    std::vector<ShardClientRecord> joins_to_forward_;
+    uint32_t shard_ = 0;
+    uint32_t num_shards_ = 1;
+    /** protects the messages between the shards (provisioned or derived from the seal key of the enclave) */
+    sgx_key_128bit_t sk_shards_{};
+    /** the session of this enclave (see ShardMessageAad) */
+    uint64_t session_ = 0;
+
+    /**
+     * Another shard of the login server, as seen by this one.
+     */
+    struct ShardSession {
+      Uri uri;
+      /** whether a hello has been received from the shard, i.e., session is known */
+      bool hello_received = false;
+      uint64_t session = 0;
+      /** the sequence number of the last message received from the shard */
+      uint64_t last_seq_in = 0;
+      /** the sequence number of the next message sent to the shard */
+      uint64_t next_seq_out = 1;
+    };
+    /** the shards (the entry of this one is only used for its uri) */
+    std::vector<ShardSession> shards_;
+    uint64_t num_required_clients_ = kDefaultNumRequiredClients;
+    /** dimension of the overlay network (chosen such that there are about kNumNodesPerQuorum nodes per quorum) */
+    int dimension_ = 0;
+    /** the total number of nodes in the overlay network */
+    uint64_t num_quorum_nodes_ = 0;
+
+  /**
+   * Everything the init messages are built from. The lists are built once per quorum and shared between the init
+   * messages of all clients.
+   */
+  struct BootstrapPlan {
+    std::array<uint8_t, SGX_AESGCM_KEY_SIZE> sk_pseud;
+    std::array<uint8_t, SGX_AESGCM_KEY_SIZE> sk_enc;
+    std::array<uint8_t, SGX_CMAC_KEY_SIZE> sk_routing;
+    /** for each quorum, the associated nodes */
+    std::vector<std::vector<PeerInformation>> associated_quorums;
+    /** for each quorum, the nodes emulating this quorum */
+    std::vector<std::vector<PeerInformation>> emulated_quorums;
+    /** for each quorum, gamma_route of the nodes emulating it */
+    std::vector<std::map<uint64_t, std::vector<PeerInformation>>> gamma_route_for_quorum;
+    /** maps each client to its associated quorum */
+    std::vector<uint64_t> clients_associated_quorums;
+    /** maps each client to the quorum it emulates */
+    std::vector<uint64_t> clients_emulated_quorums;
+  } plan_;
+  bool bootstrap_prepared_ = false;
+  std::atomic<size_t> num_finished_workers_{0};
+  std::atomic<bool> initialized{false};
 
 
 };
@@ -57,9 +190,10 @@ private:
 extern "C" {
 #endif
 
-void ecall_init() { c1::server::ServerEnclave::instance().init(); }
-void ecall_received_msg_from_client(const char *ptr, size_t len) {c1::server::ServerEnclave::instance().received_msg_from_client(ptr, len);}
+void ecall_init(uint64_t num_required_clients, uint32_t shard, uint32_t num_shards, const char *shard_uris, const uint8_t *sk_shards, size_t key_len) { c1::server::ServerEnclave::instance().init(num_required_clients, shard, num_shards, shard_uris, sk_shards, key_len); }
+int ecall_received_msgs_from_clients(const char *batch, size_t len) {return c1::server::ServerEnclave::instance().received_msgs_from_clients(batch, len);}
 int ecall_main_loop() { return c1::server::ServerEnclave::instance().main_loop(); }
+void ecall_bootstrap_worker(size_t worker, size_t num_workers) { c1::server::ServerEnclave::instance().bootstrap_worker(worker, num_workers); }
 
 #if defined(__cplusplus)
 }
@@ -1,7 +1,67 @@
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
 #include "server.h"
+#include "../../include/shared_structs.h"
 
+namespace {
+
+/**
+ * Reads the file of a sharded login server: one line shard=<ip>:<port> per shard (in the order of the shards) and
+ * optionally one line key=<32 hex digits>, the key of the messages between the shards.
+ * @return false if the file cannot be read or is malformed
+ */
+bool read_shard_file(c1::server::ShardConfig &shards, const std::string &path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot read shard file " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        std::replace(line.begin(), line.end(), '=', ' ');
+        std::istringstream line_stream(line);
+        std::string key, value;
+        if (!(line_stream >> key)) {
+            continue;
+        }
+        line_stream >> value;
+        c1::Uri uri;
+        if (key == "shard" && c1::Uri::parse(value, uri)) {
+            shards.uris.push_back(value);
+        } else if (key == "key" && value.size() == 2 * SGX_AESGCM_KEY_SIZE
+            && value.find_first_not_of("0123456789abcdefABCDEF") == std::string::npos) {
+            shards.key.clear();
+            for (size_t i = 0; i < value.size(); i += 2) {
+                shards.key.push_back(std::stoul(value.substr(i, 2), nullptr, 16));
+            }
+        } else {
+            std::cerr << "Invalid line in shard file " << path << ": " << line << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+}
 
 int main(int argc, char *argv[]) {
     using namespace c1::server;
-    return Server::instance().run();
-}
\ No newline at end of file
+    // the number of clients can be given as first argument (default: 81), a sharded login server is started by
+    // giving each process its shard and the number of shards as well (shard 0 is the leader), and optionally the
+    // shard file (see read_shard_file)
+    uint64_t num_required_clients = argc > 1 ? std::stoull(argv[1]) : 81;
+    uint32_t shard = argc > 3 ? std::stoul(argv[2]) : 0;
+    uint32_t num_shards = argc > 3 ? std::stoul(argv[3]) : 1;
+    ShardConfig shards;
+    if (shard >= num_shards || (argc > 4 && !read_shard_file(shards, argv[4]))
+        || (!shards.uris.empty() && shards.uris.size() != num_shards)) {
+        std::cerr << "usage: " << argv[0] << " [<number of clients> [<shard> <number of shards> [<shard file>]]]"
+                  << std::endl;
+        return 1;
+    }
+    return Server::instance().run(num_required_clients, shard, num_shards, shards);
+}
@@ -4,7 +4,9 @@
 
 #include "network_manager_server.h"
 #include "../enclave_u.h"
+#include "../../../include/shared_structs.h"
 #include <thread>
+#include <iostream>
 
 namespace c1::server {
 
@@ -13,31 +15,57 @@ static constexpr auto HEARTBEAT_LIVENESS = 3;
 
 NetworkManagerServer::NetworkManagerServer()
     : context_(1), socket_in_(context_, ZMQ_ROUTER), clients_{}, global_sgx_eid_(0),
-      pollitems_{socket_in_, 0, ZMQ_POLLIN, 0} {
-    socket_in_.bind("tcp://*:5671"); // todo: move somewhere else...
+      pollitems_{socket_in_, 0, ZMQ_POLLIN, 0} {}
+
+void NetworkManagerServer::bind(uint16_t port) {
+    socket_in_.bind("tcp://*:" + std::to_string(port));
 }
 
-bool NetworkManagerServer::main_loop() {
-    //static int run{0};
+bool NetworkManagerServer::main_loop(long timeout_ms) {
+    zmq::poll(&pollitems_[0], 1, timeout_ms);
 
-    zmq::poll(&pollitems_[0], 1, 0);
+    if (!(pollitems_[0].revents & ZMQ_POLLIN)) {
+        return true;
+    }
 
-    if (pollitems_[0].revents & ZMQ_POLLIN) {
+    // drain the socket: each message is appended to the batch (preceded by its length)
+    batch_.clear();
+    size_t num_messages = 0;
+    zmq::message_t msg_client_identity;
+    zmq::message_t msg_content;
+    while (num_messages < kMaxBatchMessages && socket_in_.recv(&msg_client_identity, ZMQ_DONTWAIT)) {
         // receive identity of client
-        zmq::message_t msg_client_identity;
-        socket_in_.recv(&msg_client_identity);
         assert(msg_client_identity.more());
-        //client_id_ = std::string(static_cast<char *>(msg_client_identity.data()), msg_client_identity.size());
-        //std::cout << "UNTRUSTED(server): Received message from client " << client_id_ << std::endl;
 
-        // receive actual message content
-        zmq::message_t msg_content;
+        // receive actual message content (the parts of a message arrive together)
         socket_in_.recv(&msg_content);
         assert(!msg_content.more());
 
-        ecall_received_msg_from_client(global_sgx_eid_, reinterpret_cast<char*>(msg_content.data()), msg_content.size());
+        ClientMessageBatchRecordHeader record_header{msg_content.size()};
+        auto offset = batch_.size();
+        batch_.resize(offset + sizeof(record_header) + msg_content.size());
+        memcpy(batch_.data() + offset, &record_header, sizeof(record_header));
+        memcpy(batch_.data() + offset + sizeof(record_header), msg_content.data(), msg_content.size());
+        num_messages++;
+    }
+    if (num_messages == 0) {
+        return true;
     }
 
+    if (!first_message_time_) {
+        first_message_time_ = std::chrono::steady_clock::now();
+    }
+    num_received_messages_ += num_messages;
+    num_received_batches_++;
+    int bootstrap_ready = 0;
+    auto ret = ecall_received_msgs_from_clients(global_sgx_eid_, &bootstrap_ready, batch_.data(), batch_.size());
+    if (ret != SGX_SUCCESS) {
+        std::cerr << "ecall_received_msgs_from_clients failed (error 0x" << std::hex << ret << std::dec << ")"
+                  << std::endl;
+        return false;
+    }
+    bootstrap_ready_ = bootstrap_ready;
+
     return true;
 }
 
@@ -50,6 +78,7 @@ void NetworkManagerServer::send_msg_to_client(const std::string &recipient, cons
     if (clients_.count(recipient) < 1) {
 //        std::cout << "Establishing connection to client " << recipient << std::endl;
         clients_.emplace(recipient, Client{zmq::socket_t(context_, ZMQ_DEALER)});
+        clients_.at(recipient).socket.setsockopt(ZMQ_LINGER, kLingerMs);
         clients_.at(recipient).socket.connect("tcp://" + recipient);
     }
     // send message to recipient
@@ -62,4 +91,14 @@ void NetworkManagerServer::send_msg_to_client(const std::string &recipient, cons
 //    std::cout << "(UNTRUSTED) Server: Sent message to client..." << std::endl;
 }
 
+void NetworkManagerServer::close() {
+    socket_in_.setsockopt(ZMQ_LINGER, 0);
+    socket_in_.close();
+    for (auto &[uri, client] : clients_) {
+        client.socket.close();
+    }
+    // terminating the context waits for the sockets to send their queued messages (or to time out)
+    context_.close();
+}
+
 } // ~namespace
\ No newline at end of file
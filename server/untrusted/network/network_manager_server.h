@@ -4,6 +4,9 @@
 #include <zmq.h>
 #include <zmq.hpp>
 #include <unordered_map>
+#include <vector>
+#include <optional>
+#include <chrono>
 #include <sgx_eid.h>
 
 namespace c1::server {
@@ -24,6 +27,12 @@ class NetworkManagerServer {
   /** Constructor. */
   NetworkManagerServer();
 
+  /**
+   * Bind the incoming socket.
+   * @param port
+   */
+  void bind(uint16_t port);
+
   /**
  * Called once the global_sgx_eid is available.
  * @param global_sgx_eid_
@@ -31,10 +40,12 @@ class NetworkManagerServer {
   void setGlobal_sgx_eid_(sgx_enclave_id_t global_sgx_eid_);
 
   /**
- * Called regularly.
- * @return true
+ * Called regularly. Waits (at most timeout_ms) for messages from clients and passes everything that has arrived
+ * (up to kMaxBatchMessages messages) to the enclave in one ecall.
+ * @param timeout_ms
+ * @return false if the enclave could not be called (the server cannot continue then)
  */
-  bool main_loop();
+  bool main_loop(long timeout_ms);
 
   /**
    * Send message at ptr of length len to the peer with uri recipient.
@@ -44,6 +55,31 @@ class NetworkManagerServer {
    */
   void send_msg_to_client(const std::string &recipient, const char *ptr, size_t len);
 
+  /**
+   * Closes all sockets. Blocks until the queued messages have been sent (at most kLingerMs per socket).
+   */
+  void close();
+
+  /** whether all clients have joined (reported by the enclave), i.e., the bootstrap can be started */
+  bool bootstrap_ready() const {
+    return bootstrap_ready_;
+  }
+
+  /** the number of messages received from clients */
+  uint64_t num_received_messages() const {
+    return num_received_messages_;
+  }
+
+  /** the number of batches the received messages have been passed to the enclave in */
+  uint64_t num_received_batches() const {
+    return num_received_batches_;
+  }
+
+  /** when the first message from a client has been received (empty if none has been received yet) */
+  const std::optional<std::chrono::steady_clock::time_point> &first_message_time() const {
+    return first_message_time_;
+  }
+
  private:
   /** zeromq context */
   zmq::context_t context_;
@@ -55,6 +91,16 @@ class NetworkManagerServer {
   sgx_enclave_id_t global_sgx_eid_;
   /** poller for the incoming socket */
   zmq::pollitem_t pollitems_[1];
+  /** how long the queued messages of a socket are still tried to be sent once it is closed */
+  static constexpr int kLingerMs = 10000;
+  /** the maximal number of messages passed to the enclave in one ecall */
+  static constexpr size_t kMaxBatchMessages = 1024;
+  /** the batch of messages for the enclave (kept to reuse its memory) */
+  std::vector<char> batch_;
+  uint64_t num_received_messages_ = 0;
+  uint64_t num_received_batches_ = 0;
+  bool bootstrap_ready_ = false;
+  std::optional<std::chrono::steady_clock::time_point> first_message_time_;
 };
 
 } // ~namespace
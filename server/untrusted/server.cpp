@@ -7,6 +7,7 @@
 #include "enclave_u.h"
 #include "sgx_urts.h"
 #include "../../include/errors.h"
+#include "../../include/shared_structs.h"
 
 #include <unistd.h>
 #include <pwd.h>
@@ -99,7 +100,7 @@ int Server::initialize_enclave() {
 }
 
 
-int Server::run() {
+int Server::run(uint64_t num_required_clients, uint32_t shard, uint32_t num_shards, const ShardConfig &shards) {
     /* Initialize the enclave */
     if (initialize_enclave() < 0) {
         printf("Enter a character before exit ...\n");
@@ -107,16 +108,40 @@ int Server::run() {
         throw std::runtime_error("");
     }
 
-    ecall_init(global_eid_);
+    std::string shard_uris;
+    for (const auto &uri : shards.uris) {
+        shard_uris += (shard_uris.empty() ? "" : ",") + uri;
+    }
+    ecall_init(global_eid_, num_required_clients, shard, num_shards, shard_uris.c_str(), shards.key.data(),
+               shards.key.size());
 
+    uint16_t port = kLoginServerPort + shard;
+    Uri own_uri;
+    if (!shards.uris.empty() && Uri::parse(shards.uris.at(shard), own_uri)) {
+        port = own_uri.port;
+    }
     /* Inform the network manager of the global_eid_ */
     network_manager_.setGlobal_sgx_eid_(global_eid_);
+    network_manager_.bind(port);
 
-    std::cout << "Successfully initialized server!" << std::endl;
+    std::cout << "Successfully initialized server";
+    if (num_shards > 1) {
+        std::cout << " (shard " << shard << " of " << num_shards << ")";
+    }
+    std::cout << ", listening on port " << port << "!" << std::endl;
 
     //main loop
+    int result = 0;
     while (true) {
-        if (!network_manager_.main_loop()) {
+        if (!network_manager_.main_loop(kPollTimeoutMs)) {
+            result = 1;
+            break;
+        }
+        send_queued_batches();
+        if (network_manager_.bootstrap_ready() && !bootstrap()) {
+            // some clients may have received their init messages already, so the bootstrap cannot be repeated
+            std::cerr << "Bootstrap failed, shutting down" << std::endl;
+            result = 1;
             break;
         }
 
@@ -125,11 +150,11 @@ int Server::run() {
         if (!return_value) {
             break;
         }
-
-        using namespace std::chrono_literals;
-        std::this_thread::sleep_for(0.01s);
     }
 
+    // the last init messages (and the plan of a leader) may still be queued in the sockets
+    network_manager_.close();
+
     /* Destroy the enclave */
     sgx_destroy_enclave(global_eid_);
 
@@ -137,7 +162,7 @@ int Server::run() {
 
 //    printf("Enter a character before exit ...\n");
 //    getchar();
-    return 0;
+    return result;
 }
 
 void Server::send_msg_to_client(const std::string &recipient, const char *msg, size_t msg_len) {
@@ -145,6 +170,109 @@ void Server::send_msg_to_client(const std::string &recipient, const char *msg, s
     network_manager_.send_msg_to_client(recipient, msg, msg_len);
 }
 
+void Server::enqueue_bootstrap_batch(const char *batch, size_t len) {
+    {
+        std::lock_guard<std::mutex> lock(bootstrap_mutex_);
+        bootstrap_batches_.emplace_back(batch, batch + len);
+    }
+    bootstrap_cv_.notify_one();
+}
+
+void Server::send_queued_batches() {
+    std::deque<std::vector<char>> batches;
+    {
+        std::lock_guard<std::mutex> lock(bootstrap_mutex_);
+        std::swap(batches, bootstrap_batches_);
+    }
+    for (const auto &batch : batches) {
+        send_bootstrap_batch(batch);
+    }
+}
+
+bool Server::bootstrap() {
+    auto start = std::chrono::steady_clock::now();
+    print_join_throughput(start);
+    auto num_workers = std::max(1u, std::min(std::thread::hardware_concurrency(), kMaxBootstrapWorkers));
+
+    {
+        std::lock_guard<std::mutex> lock(bootstrap_mutex_);
+        num_finished_workers_ = 0;
+    }
+    std::vector<sgx_status_t> worker_status(num_workers, SGX_SUCCESS);
+    std::vector<std::thread> workers;
+    for (unsigned worker = 0; worker < num_workers; ++worker) {
+        workers.emplace_back([this, worker, num_workers, &worker_status] {
+            worker_status[worker] = ecall_bootstrap_worker(global_eid_, worker, num_workers);
+            {
+                std::lock_guard<std::mutex> lock(bootstrap_mutex_);
+                num_finished_workers_++;
+            }
+            bootstrap_cv_.notify_one();
+        });
+    }
+
+    // stream the batches out while the workers are still serializing
+    size_t num_messages = 0;
+    while (true) {
+        std::unique_lock<std::mutex> lock(bootstrap_mutex_);
+        bootstrap_cv_.wait(lock, [this, num_workers] {
+            return !bootstrap_batches_.empty() || num_finished_workers_ == num_workers;
+        });
+        if (bootstrap_batches_.empty()) {
+            break; // all workers returned and all batches have been sent
+        }
+        auto batch = std::move(bootstrap_batches_.front());
+        bootstrap_batches_.pop_front();
+        lock.unlock();
+        num_messages += send_bootstrap_batch(batch);
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    for (unsigned worker = 0; worker < num_workers; ++worker) {
+        if (worker_status[worker] != SGX_SUCCESS) {
+            std::cerr << "Bootstrap worker " << worker << " failed:" << std::endl;
+            print_error_message(worker_status[worker]);
+            return false;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    auto to_ms = [](std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    };
+    std::cout << "Sent " << num_messages << " init messages (" << num_workers << " workers) in " << to_ms(end - start)
+              << " ms, " << to_ms(end - network_manager_.first_message_time().value_or(start))
+              << " ms after the first join message" << std::endl;
+    return true;
+}
+
+void Server::print_join_throughput(std::chrono::steady_clock::time_point now) const {
+    auto num_messages = network_manager_.num_received_messages();
+    auto duration = std::chrono::duration<double>(now - network_manager_.first_message_time().value_or(now)).count();
+    std::cout << "Received " << num_messages << " join messages in " << network_manager_.num_received_batches()
+              << " batches within " << static_cast<uint64_t>(duration * 1000) << " ms";
+    if (duration > 0) {
+        std::cout << " (" << static_cast<uint64_t>(num_messages / duration) << " joins/s)";
+    }
+    std::cout << std::endl;
+}
+
+size_t Server::send_bootstrap_batch(const std::vector<char> &batch) {
+    size_t num_messages = 0;
+    for (size_t cur = 0; cur + sizeof(BootstrapBatchRecordHeader) <= batch.size(); num_messages++) {
+        BootstrapBatchRecordHeader record_header;
+        memcpy(&record_header, batch.data() + cur, sizeof(record_header));
+        cur += sizeof(record_header);
+        std::string uri(batch.data() + cur, record_header.uri_len);
+        cur += record_header.uri_len;
+        assert(cur + record_header.msg_len <= batch.size());
+        send_msg_to_client(uri, batch.data() + cur, record_header.msg_len);
+        cur += record_header.msg_len;
+    }
+    return num_messages;
+}
+
 } // ~namespace
 
 /* OCall functions */
@@ -155,7 +283,7 @@ void ocall_print_string(const char *str) {
     printf("%s", str);
 }
 
-void ocall_send_msg_to_client(const char *client_uri, const char *msg, size_t msg_len) {
-    c1::server::Server::instance().send_msg_to_client(client_uri, msg, msg_len);
+void ocall_send_msgs_to_clients(const char *batch, size_t len) {
+    c1::server::Server::instance().enqueue_bootstrap_batch(batch, len);
 }
 
@@ -8,9 +8,25 @@
 #include "network/network_manager_server.h"
 #include <sgx_eid.h>
 #include <cstdio>
+#include <vector>
+#include <string>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 namespace c1::server {
 
+/**
+ * Where the shards of a sharded login server run and how they protect the messages between them (see README).
+ */
+struct ShardConfig {
+  /** the uris of the shards as seen by the other shards (empty: shard k listens on kLoginServerPort + k of localhost) */
+  std::vector<std::string> uris;
+  /** the key of the messages between the shards (empty: derived from the seal key, on a single machine only) */
+  std::vector<uint8_t> key;
+};
+
 /**
  * Main login server class.
  */
@@ -26,7 +42,15 @@ class Server {
 
   }
 
-  int run();
+  /**
+   * main loop
+   * @param num_required_clients the number of clients the system is initialized with
+   * @param shard the shard of a sharded login server this process is (0 is the leader), it listens on the port of its
+   * uri in shards (kLoginServerPort + shard by default)
+   * @param num_shards 1 if the login server is not sharded
+   * @param shards
+   */
+  int run(uint64_t num_required_clients, uint32_t shard = 0, uint32_t num_shards = 1, const ShardConfig &shards = {});
 
   /**
    * Send a message to the peer with uri recipient.
@@ -35,15 +59,53 @@ class Server {
    * @param msg_len
    */
   void send_msg_to_client(const std::string &recipient, const char *msg, size_t msg_len);
+  /**
+   * Called by the enclave (by the bootstrap workers concurrently): queues a batch of init messages (or messages to
+   * other shards) to be sent by the main thread.
+   * @param batch see ocall_send_msgs_to_clients
+   * @param len
+   */
+  void enqueue_bootstrap_batch(const char *batch, size_t len);
 
  private:
+  /** how long the main loop waits for messages from clients before calling ecall_main_loop */
+  static constexpr long kPollTimeoutMs = 100;
+  /** the number of threads serializing init messages (must be below TCSNum, see settings/enclave.config.xml) */
+  static constexpr unsigned kMaxBootstrapWorkers = 8;
+
   Server();
 
   int initialize_enclave();
 
+  /**
+   * Runs the bootstrap workers of the enclave and sends their init messages (as they come in) to the clients.
+   * @return false if a worker could not be run (the bootstrap is incomplete then)
+   */
+  bool bootstrap();
+  /**
+   * Sends all queued batches (outside of the bootstrap, e.g., the messages between the shards).
+   */
+  void send_queued_batches();
+  /**
+   * Prints how fast the clients have joined (from the first join message until now).
+   * @param now
+   */
+  void print_join_throughput(std::chrono::steady_clock::time_point now) const;
+  /**
+   * Sends the init messages of a batch.
+   * @return the number of messages sent
+   */
+  size_t send_bootstrap_batch(const std::vector<char> &batch);
+
   /* Global EID shared by multiple threads */
   sgx_enclave_id_t global_eid_ = 0;
   NetworkManagerServer network_manager_;
+  /** the batches of init messages not sent yet, guarded by bootstrap_mutex_ */
+  std::deque<std::vector<char>> bootstrap_batches_;
+  /** the number of bootstrap workers that returned, guarded by bootstrap_mutex_ */
+  size_t num_finished_workers_ = 0;
+  std::mutex bootstrap_mutex_;
+  std::condition_variable bootstrap_cv_;
 };
 
 } // ~namespace
@@ -54,7 +116,7 @@ extern "C" {
 #endif
 
 void ocall_print_string(const char *str);
-void ocall_send_msg_to_client(const char *client_uri, const char *msg, size_t msg_len);
+void ocall_send_msgs_to_clients(const char *batch, size_t len);
 
 #if defined(__cplusplus)
 }
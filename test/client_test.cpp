@@ -1,6 +1,14 @@
 #define BOOST_TEST_MODULE StructureTest
 #include <boost/test/included/unit_test.hpp>
 #include "../client/trusted/structures/aad_tuple.h"
+#include "../client/trusted/structures/peer_registry.h"
+#include "../client/trusted/structures/outbox.h"
+#include "../client/trusted/round_arena.h"
+#include "../client/trusted/structures/inbox.h"
+#include "../client/trusted/structures/calendar_queue.h"
+#include "../client/trusted/structures/pseudonym_inbox.h"
+#include "../client/trusted/traffic_out_recorder.h"
+#include "../client/trusted/structures/agreement_runs.h"
 
 using namespace boost::unit_test;
 
@@ -17,6 +25,303 @@ BOOST_AUTO_TEST_CASE(aad_serialization_test) {
   size_t cur = 0;
   auto a2 = c1::client::AadTuple::deserialize(vec, cur);
   BOOST_ASSERT(a1 == a2);
+
+  // the header can be deserialized on its own
+  std::vector<uint8_t> header(vec.begin(), vec.begin() + c1::client::AadTuple::kHeaderSize);
+  c1::PeerInformation sender, receiver;
+  round_t round;
+  cur = 0;
+  c1::client::AadTuple::deserialize_header(header, cur, sender, receiver, round);
+  BOOST_ASSERT(cur == header.size());
+  BOOST_ASSERT(sender == a1.sender && receiver == a1.receiver && round == a1.round);
+}
+
+BOOST_AUTO_TEST_CASE(agreement_tuple_serialization_test) {
+  uint8_t n_src[kPseudonymSize] = {1, 2, 3};
+  uint8_t msg[kMessageSize] = {4, 5, 6};
+  uint8_t n_dst[kPseudonymSize] = {7, 8, 9};
+  c1::client::MessageTuple m{c1::client::Pseudonym{n_src}, c1::client::Message{msg}, c1::client::Pseudonym{n_dst}, 96};
+  std::vector<c1::client::AgreementTuple> a1{c1::client::AgreementTuple{m, {12, 72, 3}, 2},
+                                             c1::client::AgreementTuple{m, {}, 4}};
+  std::vector<uint8_t> vec;
+  c1::serialize_vec(vec, a1);
+  size_t cur = 0;
+  auto a2 = c1::deserialize_vec<c1::client::AgreementTuple>(vec, cur);
+  BOOST_ASSERT(cur == vec.size());
+  BOOST_ASSERT(a1 == a2);
+}
+
+BOOST_AUTO_TEST_CASE(overlay_view_test) {
+  c1::PeerInformation own_id{1, c1::Uri(127, 0, 0, 1, 10001)};
+  std::map<uint64_t, std::vector<c1::PeerInformation>> gamma_route;
+  gamma_route[0] = {own_id, c1::PeerInformation{2, c1::Uri(127, 0, 0, 1, 10002)}};
+  gamma_route[1] = {c1::PeerInformation{3, c1::Uri(127, 0, 0, 1, 10003)}};
+  c1::client::OverlayStructureScheme overlay;
+  overlay.init(0, 0, gamma_route.at(1), gamma_route.at(0), gamma_route, 1, 8, own_id);
+
+  const auto &view = overlay.update(3, {});
+  auto version = view.version;
+  auto gamma_agree = view.gamma_agree;
+  BOOST_ASSERT(*gamma_agree == gamma_route.at(0));
+  BOOST_ASSERT(view.gamma_route == gamma_route);
+
+  // no reconfiguration in this round, thus the view must not have been rebuilt
+  const auto &view2 = overlay.update(4, {});
+  BOOST_ASSERT(&view == &view2);
+  BOOST_ASSERT(view2.version == version);
+  BOOST_ASSERT(view2.gamma_agree == gamma_agree);
+}
+
+BOOST_AUTO_TEST_CASE(peer_set_test) {
+  c1::PeerInformation p1{1, c1::Uri(127, 0, 0, 1, 10001)};
+  c1::PeerInformation p2{2, c1::Uri(127, 0, 0, 1, 10002)};
+  c1::PeerInformation p3{3, c1::Uri(127, 0, 0, 1, 10003)};
+  c1::client::PeerSet set{std::vector<c1::PeerInformation>{p3, p1}};
+  BOOST_ASSERT(!set.insert(p1));
+  BOOST_ASSERT(set.insert(p2));
+  set.insert(std::vector<c1::PeerInformation>{p2, p3, p1});
+  BOOST_ASSERT(set.contains(2));
+  BOOST_ASSERT(set.peers() == (std::vector<c1::PeerInformation>{p3, p1, p2}));
+
+  auto peers = set.release();
+  BOOST_ASSERT(peers.size() == 3);
+  BOOST_ASSERT(set.empty());
+  BOOST_ASSERT(set.insert(p1));
+}
+
+BOOST_AUTO_TEST_CASE(peer_registry_test) {
+  c1::client::PeerRegistry registry;
+  auto h1 = registry.intern(c1::PeerInformation{12, c1::Uri(127, 0, 0, 1, 10012)});
+  auto h2 = registry.intern(c1::PeerInformation{72, c1::Uri(127, 0, 0, 1, 10072)});
+  BOOST_ASSERT(h1 == 0 && h2 == 1);
+  BOOST_ASSERT(registry.intern(c1::PeerInformation{12, c1::Uri(127, 0, 0, 1, 10013)}) == h1);
+  BOOST_ASSERT(registry.at(h1).uri == c1::Uri(127, 0, 0, 1, 10013));
+  BOOST_ASSERT(registry.find(72) == h2);
+  BOOST_ASSERT(registry.find(3) == c1::client::PeerRegistry::kNoPeer);
+  BOOST_ASSERT(registry.size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(outbox_reset_test) {
+  c1::client::Outbox outbox;
+  outbox.for_peer(3).announce.push_back(c1::client::MessageTuple::create_dummy());
+  outbox.for_peer(1).deliver.push_back(c1::client::MessageTuple::create_dummy());
+  outbox.for_peer(3).inject.push_back(c1::client::MessageTuple::create_dummy());
+  BOOST_ASSERT(outbox.receivers() == (std::vector<c1::client::peer_handle_t>{3, 1}));
+
+  auto capacity = outbox.at(3).announce.capacity();
+  outbox.reset();
+  BOOST_ASSERT(outbox.receivers().empty());
+  BOOST_ASSERT(outbox.at(3).announce.empty() && outbox.at(3).inject.empty() && outbox.at(1).deliver.empty());
+  BOOST_ASSERT(outbox.at(3).announce.capacity() == capacity);
+
+  outbox.for_peer(1);
+  BOOST_ASSERT(outbox.receivers() == (std::vector<c1::client::peer_handle_t>{1}));
+}
+
+BOOST_AUTO_TEST_CASE(round_arena_test) {
+  c1::client::RoundArena arena(64);
+  c1::client::ArenaAllocator<uint64_t> allocator(arena);
+  c1::client::arena_vector<uint64_t> vec(allocator);
+  for (uint64_t i = 0; i < 100; ++i) {
+    vec.push_back(i);
+  }
+  BOOST_ASSERT(vec[99] == 99);
+  BOOST_ASSERT(reinterpret_cast<uintptr_t>(vec.data()) % alignof(uint64_t) == 0);
+  BOOST_ASSERT(arena.stats().heap_blocks > 1);
+  auto bytes = arena.stats().bytes;
+
+  vec = c1::client::arena_vector<uint64_t>(allocator);
+  arena.reset();
+  BOOST_ASSERT(arena.stats().peak_bytes == bytes);
+  auto heap_blocks = arena.stats().heap_blocks;
+  // after the reset, the same round fits into a single block
+  for (uint64_t i = 0; i < 100; ++i) {
+    vec.push_back(i);
+  }
+  BOOST_ASSERT(arena.stats().heap_blocks == heap_blocks);
+}
+
+BOOST_AUTO_TEST_CASE(inbox_ring_test) {
+  c1::client::Inbox inbox;
+  inbox.current().announce.push_back(c1::client::MessageTuple::create_dummy());
+  inbox.current().announce.push_back(c1::client::MessageTuple::create_dummy());
+  inbox.for_round(1).inject.push_back(c1::client::MessageTuple::create_cancel());
+  inbox.for_round(1).received_from.insert(3);
+  auto *current_slot = &inbox.current();
+
+  inbox.advance();
+  BOOST_ASSERT(inbox.current().inject.size() == 1 && inbox.current().received_from.count(3) == 1);
+  // the slot of the previous round is cleared and reserved for the round after the current one
+  BOOST_ASSERT(&inbox.for_round(1) == current_slot);
+  BOOST_ASSERT(current_slot->announce.empty());
+  BOOST_ASSERT(current_slot->announce.capacity() >= 2);
+}
+
+BOOST_AUTO_TEST_CASE(deserialize_skipping_dummies_test) {
+  uint8_t n_src[kPseudonymSize] = {1, 2, 3};
+  uint8_t msg[kMessageSize] = {4, 5, 6};
+  uint8_t n_dst[kPseudonymSize] = {7, 8, 9};
+  c1::client::MessageTuple m{c1::client::Pseudonym{n_src}, c1::client::Message{msg}, c1::client::Pseudonym{n_dst}, 96};
+  c1::client::RoutingSchemeTuple r{m, 3, c1::client::Pseudonym{n_dst}, 12, 1};
+  std::vector<uint8_t> vec;
+  c1::serialize_vec(vec, std::vector<c1::client::MessageTuple>{c1::client::MessageTuple::create_dummy(), m,
+                                                               c1::client::MessageTuple::create_dummy()});
+  c1::serialize_vec(vec, std::vector<c1::client::RoutingSchemeTuple>{c1::client::RoutingSchemeTuple::create_dummy(),
+                                                                     r});
+  BOOST_ASSERT(vec.size() == 2 * sizeof(size_t) + 3 * c1::client::MessageTuple::kSerializedSize
+      + 2 * c1::client::RoutingSchemeTuple::kSerializedSize);
+
+  size_t cur = 0;
+  std::vector<c1::client::MessageTuple> messages;
+  c1::deserialize_vec_each<c1::client::MessageTuple>(vec, cur, [&](c1::client::MessageTuple &&elem) {
+    messages.push_back(elem);
+  }, c1::client::MessageTuple::skip_dummy);
+  std::vector<c1::client::RoutingSchemeTuple> routing;
+  c1::deserialize_vec_each<c1::client::RoutingSchemeTuple>(vec, cur, [&](c1::client::RoutingSchemeTuple &&elem) {
+    routing.push_back(elem);
+  }, c1::client::RoutingSchemeTuple::skip_dummy);
+  BOOST_ASSERT(cur == vec.size());
+  BOOST_ASSERT(messages.size() == 1 && messages[0] == m);
+  BOOST_ASSERT(routing.size() == 1 && !(routing[0] < r) && !(r < routing[0]));
+}
+
+BOOST_AUTO_TEST_CASE(calendar_queue_test) {
+  using Queue = c1::client::CalendarQueue<int>;
+  Queue queue;
+  std::vector<int> out;
+  BOOST_ASSERT(queue.push(3, 1));
+  BOOST_ASSERT(queue.push(3, 2));
+  BOOST_ASSERT(queue.push(5, 3));
+  BOOST_ASSERT(queue.push(Queue::kNumBuckets + 10, 4)); // beyond the ring
+  BOOST_ASSERT(queue.push(Queue::kNumBuckets + 20, 5));
+  BOOST_ASSERT(queue.size() == 5);
+
+  BOOST_ASSERT(queue.pop_round(3, out) == 0);
+  BOOST_ASSERT((out == std::vector<int>{1, 2}));
+  BOOST_ASSERT(!queue.push(2, 6)); // already taken out
+
+  // round 5 has been skipped
+  BOOST_ASSERT(queue.pop_round(6, out) == 1);
+  BOOST_ASSERT(out.empty());
+
+  // the overflow has been moved into the ring
+  BOOST_ASSERT(queue.pop_round(Queue::kNumBuckets + 10, out) == 0);
+  BOOST_ASSERT((out == std::vector<int>{4}));
+  BOOST_ASSERT(queue.push(Queue::kNumBuckets + 20, 7));
+  BOOST_ASSERT(queue.pop_round(Queue::kNumBuckets + 20, out) == 0);
+  BOOST_ASSERT((out == std::vector<int>{5, 7}));
+  BOOST_ASSERT(queue.empty());
+
+  // skipping more rounds than the ring covers
+  BOOST_ASSERT(queue.push(Queue::kNumBuckets + 30, 8));
+  BOOST_ASSERT(queue.push(5 * Queue::kNumBuckets, 9));
+  BOOST_ASSERT(queue.pop_round(5 * Queue::kNumBuckets, out) == 1);
+  BOOST_ASSERT((out == std::vector<int>{9}));
+  BOOST_ASSERT(queue.empty());
+}
+
+BOOST_AUTO_TEST_CASE(pseudonym_inbox_test) {
+  uint8_t n[kPseudonymSize] = {1};
+  uint8_t msg[kMessageSize] = {2};
+  auto message = [&](uint64_t t_dst) {
+    return c1::client::MessageTuple{c1::client::Pseudonym{n}, c1::client::Message{msg}, c1::client::Pseudonym{n}, t_dst};
+  };
+  c1::client::PseudonymInbox inbox;
+  inbox.add_pseudonym();
+  inbox.add_pseudonym();
+  inbox.push(1, message(4 * kDelta + 3));
+  inbox.push(1, message(4 * kDelta + 1));
+  inbox.push(1, message(12 * kDelta));
+  inbox.push(0, message(2));
+  BOOST_ASSERT(inbox.size() == 4);
+
+  std::vector<c1::client::MessageTuple> out;
+  BOOST_ASSERT(inbox.pop_due(1, 4 * kDelta, 10, out) == 0); // nothing due yet
+  BOOST_ASSERT(inbox.pop_due(1, 4 * kDelta + 5, 1, out) == 1);
+  BOOST_ASSERT(out.size() == 1 && out[0].t_dst == 4 * kDelta + 1);
+  BOOST_ASSERT(inbox.pop_due(1, 20 * kDelta, 10, out) == 2);
+  BOOST_ASSERT(out.size() == 3 && out[1].t_dst == 4 * kDelta + 3 && out[2].t_dst == 12 * kDelta);
+  BOOST_ASSERT(inbox.size() == 1);
+}
+
+uint64_t fake_time_ns = 0;
+
+BOOST_AUTO_TEST_CASE(traffic_out_recorder_test) {
+  c1::client::TrafficOutRecorder recorder([]() { return fake_time_ns; });
+  fake_time_ns = 100;
+  recorder.begin_round();
+  fake_time_ns = 130;
+  recorder.end_phase(TRAFFIC_OUT_PHASE_OVERLAY);
+  fake_time_ns = 200;
+  recorder.end_phase(TRAFFIC_OUT_PHASE_PADDING);
+  recorder.end_round(7);
+
+  recorder.begin_round();
+  fake_time_ns = 210;
+  recorder.end_phase(TRAFFIC_OUT_PHASE_OVERLAY);
+  recorder.end_round(8);
+
+  const auto &stats = recorder.stats();
+  BOOST_ASSERT(stats.last_round_number == 8);
+  BOOST_ASSERT(stats.last_round.rounds == 1 && stats.last_round.phase_ns[TRAFFIC_OUT_PHASE_OVERLAY] == 10);
+  BOOST_ASSERT(stats.slowest_round.phase_ns[TRAFFIC_OUT_PHASE_PADDING] == 70); // the first round took 100 ns
+  BOOST_ASSERT(stats.total.rounds == 2);
+  BOOST_ASSERT(stats.total.phase_ns[TRAFFIC_OUT_PHASE_OVERLAY] == 40);
+  BOOST_ASSERT(stats.arena.heap_blocks == 0);
+  recorder.set_arena(traffic_out_arena_stats_t{5, 640, 2});
+  BOOST_ASSERT(recorder.stats().arena.last_round_allocations == 5 && recorder.stats().arena.peak_bytes == 640);
+}
+
+BOOST_AUTO_TEST_CASE(agreement_output_size_test) {
+  constexpr size_t kAnnounces = 4;
+  auto participating_nodes = std::make_shared<const std::vector<c1::client::peer_handle_t>>(
+      std::vector<c1::client::peer_handle_t>{0, 1, 2});
+  auto no_aware_nodes = [](const c1::client::MessageTuple &, const c1::client::AgreementLocalTuple &) {
+    return c1::client::ParticipantSet();
+  };
+  // whether k of the announces are real messages or dummies must not change what is sent
+  std::vector<size_t> agreement_messages;
+  for (size_t k = 0; k <= kAnnounces; ++k) {
+    c1::client::AgreementRuns runs;
+    for (size_t i = 0; i < kAnnounces; ++i) {
+      auto message = c1::client::MessageTuple::create_dummy();
+      if (i < k) {
+        uint8_t m[kMessageSize] = {static_cast<uint8_t>(i + 1)};
+        message = c1::client::MessageTuple{message.n_src, c1::client::Message{m}, message.n_dst, 96};
+      }
+      BOOST_ASSERT(runs.start(message, true, participating_nodes, 1, 0));
+    }
+    BOOST_ASSERT(runs.size() == kAnnounces);
+    size_t num_messages = 0;
+    runs.update(no_aware_nodes, [&](const c1::client::MessageTuple &,
+                                    const c1::client::AgreementLocalTuple &,
+                                    const c1::client::DistributedAgreementSchemeOutput &output) {
+      num_messages += output.receivers.count();
+    });
+    agreement_messages.push_back(num_messages);
+  }
+  for (auto num_messages : agreement_messages) {
+    BOOST_ASSERT(num_messages == kAnnounces * participating_nodes->size());
+  }
+
+  // nodes that are no participants do not start a run
+  c1::client::AgreementRuns runs;
+  BOOST_ASSERT(!runs.start(c1::client::MessageTuple::create_dummy(), true, participating_nodes, 5, 0));
+  BOOST_ASSERT(runs.size() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(agreement_scheme_bounds_test) {
+  c1::client::DistributedAgreementScheme scheme;
+  c1::client::ParticipantSet no_aware_nodes;
+  // oversized runs and positions outside the run are rejected instead of touching the participant sets
+  auto output = scheme.update(true, c1::client::kMaxAgreementParticipants + 1, 0, no_aware_nodes, 1);
+  BOOST_ASSERT(output.receivers.none() && output.aware_nodes.none());
+  output = scheme.update(true, 3, 3, no_aware_nodes, 1);
+  BOOST_ASSERT(output.receivers.none() && output.aware_nodes.none());
+  BOOST_ASSERT(!scheme.finalize(c1::client::kMaxAgreementParticipants, no_aware_nodes, 0));
+
+  output = scheme.update(true, 3, 2, no_aware_nodes, 1);
+  BOOST_ASSERT(output.receivers.count() == 3 && output.aware_nodes.test(2));
 }
 
 BOOST_AUTO_TEST_SUITE_END();
\ No newline at end of file
@@ -1,6 +1,8 @@
 #define BOOST_TEST_MODULE SharedStructsTest
 #include <boost/test/included/unit_test.hpp>
 #include "../include/shared_structs.h"
+#include "../server/trusted/quorum_assignment.h"
+#include <random>
 
 using namespace boost::unit_test;
 
@@ -68,9 +70,10 @@ BOOST_AUTO_TEST_CASE(init_message_test) {
   BOOST_ASSERT(im.get_sk_enc_()[0] == 2);
   BOOST_ASSERT(im.get_sk_routing_()[0] == 3);
 
-  auto im_serialized = im.serialize().first;
+  auto[im_serialized, im_serialized_len] = im.serialize();
 
-  c1::InitMessage im_deserialized(im_serialized.get());
+  c1::InitMessage im_deserialized(im_serialized.get(), im_serialized_len);
+  BOOST_ASSERT(im_deserialized.is_valid());
   BOOST_ASSERT(im_deserialized.get_receiver_id_() == 1);
   BOOST_ASSERT(im_deserialized.get_num_total_nodes_() == 20);
   BOOST_ASSERT(im_deserialized.get_overlay_dimension_() == 5);
@@ -88,6 +91,32 @@ BOOST_AUTO_TEST_CASE(init_message_test) {
   BOOST_ASSERT(im_deserialized.get_sk_enc_()[0] == 2);
   BOOST_ASSERT(im_deserialized.get_sk_routing_()[0] == 3);
 
+  // truncated, overlong and foreign-version messages are rejected
+  BOOST_ASSERT(!c1::InitMessage(im_serialized.get(), im_serialized_len - 1).is_valid());
+  BOOST_ASSERT(!c1::InitMessage(im_serialized.get(), 10).is_valid());
+  std::vector<char> too_long(im_serialized.get(), im_serialized.get() + im_serialized_len);
+  too_long.push_back(0);
+  BOOST_ASSERT(!c1::InitMessage(too_long.data(), too_long.size()).is_valid());
+  std::vector<char> other_version(im_serialized.get(), im_serialized.get() + im_serialized_len);
+  other_version[sizeof(uint64_t)]++;
+  BOOST_ASSERT(!c1::InitMessage(other_version.data(), other_version.size()).is_valid());
+}
+
+BOOST_AUTO_TEST_CASE(init_message_empty_sets_test) {
+  // empty sets (even all of them, e.g., a route without peers at the end) are serialized without touching any peer
+  std::map<uint64_t, std::vector<c1::PeerInformation>> gamma_route;
+  gamma_route[4] = std::vector<c1::PeerInformation>();
+  std::array<uint8_t, SGX_AESGCM_KEY_SIZE> sk_pseud{1};
+  std::array<uint8_t, SGX_AESGCM_KEY_SIZE> sk_enc{2};
+  std::array<uint8_t, SGX_CMAC_KEY_SIZE> sk_routing{3};
+
+  std::vector<char> serialized;
+  c1::InitMessage::serialize_to(serialized, 1, 20, 5, 1, 3, {}, {}, gamma_route, sk_pseud, sk_enc, sk_routing);
+  c1::InitMessage im(serialized.data(), serialized.size());
+  BOOST_ASSERT(im.is_valid());
+  BOOST_ASSERT(im.get_gamma_send_().empty() && im.get_gamma_receive_().empty());
+  BOOST_ASSERT(im.get_gamma_route_().size() == 1 && im.get_gamma_route_().at(4).empty());
+  BOOST_ASSERT(im.get_sk_routing_()[0] == 3);
 }
 
 BOOST_AUTO_TEST_CASE(peer_information_serialization_test) {
@@ -129,5 +158,30 @@ BOOST_AUTO_TEST_CASE(peer_information_operators_and_set_test) {
   BOOST_ASSERT(i == 1);
 }
 
+BOOST_AUTO_TEST_CASE(uri_parse_test) {
+  c1::Uri uri;
+  BOOST_ASSERT(c1::Uri::parse("10.0.12.255:5671", uri) && uri == c1::Uri(10, 0, 12, 255, 5671));
+  BOOST_ASSERT(c1::Uri::parse(std::string(c1::Uri(127, 0, 0, 1, 65535)), uri) && uri == c1::Uri(127, 0, 0, 1, 65535));
+  for (const auto *malformed : {"", "10.0.0.1", "10.0.0.1:", "10.0.0:5671", "256.0.0.1:5671", "10.0.0.1:65536",
+                                "10.0.0.1:5671,", " 10.0.0.1:5671"}) {
+    BOOST_ASSERT(!c1::Uri::parse(malformed, uri));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(balanced_quorum_assignment_test) {
+  std::mt19937_64 random(7);
+  for (auto[num_clients, num_quorums] : std::vector<std::pair<uint64_t, uint64_t>>{{81, 4}, {1000, 64}, {1023, 100}}) {
+    auto quorum_of_client = c1::server::assign_balanced_quorums(num_clients, num_quorums, random);
+    BOOST_ASSERT(quorum_of_client.size() == num_clients);
+    c1::server::QuorumSizeDistribution distribution(quorum_of_client, num_quorums);
+    BOOST_ASSERT(distribution.min_size == num_clients / num_quorums);
+    BOOST_ASSERT(distribution.max_size == (num_clients + num_quorums - 1) / num_quorums);
+  }
+
+  // the assignment is a permutation: not just consecutive blocks of clients
+  auto quorum_of_client = c1::server::assign_balanced_quorums(100, 10, random);
+  BOOST_ASSERT(!std::is_sorted(quorum_of_client.begin(), quorum_of_client.end()));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
 